@@ -0,0 +1,150 @@
+// 消息批量写入基准: 逐条INSERT与MessageBatcher攒批写入的吞吐和落库延迟
+// DAO用桩代替 每条语句固定一次往返时间 每行再加一点写入开销 不依赖数据库
+// 用法: batcher_bench [消息数=20000] [往返us=200] [每行us=2] [发送线程数=4]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "dao/MessageDao.h"
+#include "service/MessageBatcher.h"
+#include "utils/Histogram.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+}
+
+void spinFor(uint64_t us) {
+    auto until = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < until) {
+    }
+}
+
+// 只实现写入 每条语句耗时 rtt + 行数 * perRow
+class StubMessageDao : public MessageDao {
+public:
+    StubMessageDao(uint64_t rttUs, uint64_t perRowUs) : rtt_us_(rttUs), per_row_us_(perRowUs) {}
+
+    QueryResult<std::vector<Message>> getRecentMessages(int, int) override { return QueryResult<std::vector<Message>>::NotFound(); }
+    QueryResult<std::vector<Message>> getRecentMessagesByUser(int, int, int) override { return QueryResult<std::vector<Message>>::NotFound(); }
+    QueryResult<void> insertMessages(const std::vector<Message>& messages) override {
+        // 同一连接上的语句串行执行
+        std::lock_guard<std::mutex> lock(mutex_);
+        spinFor(rtt_us_ + per_row_us_ * messages.size());
+        statements_.fetch_add(1, std::memory_order_relaxed);
+        return QueryResult<void>::Success();
+    }
+    QueryResult<bool> acquireWriterLock() override { return QueryResult<bool>::Success(true); }
+    QueryResult<int64_t> getMaxMessageId() override { return QueryResult<int64_t>::Success(int64_t{0}); }
+    QueryResult<std::vector<std::pair<int, int64_t>>> getRoomSequences() override {
+        return QueryResult<std::vector<std::pair<int, int64_t>>>::Success(std::vector<std::pair<int, int64_t>>{});
+    }
+    QueryResult<void> streamMessagesBefore(int, int64_t, int, const std::function<bool(const Message&)>&) override {
+        return QueryResult<void>::Success();
+    }
+
+    uint64_t statements() const { return statements_.load(); }
+
+private:
+    uint64_t rtt_us_;
+    uint64_t per_row_us_;
+    std::mutex mutex_;
+    std::atomic<uint64_t> statements_{0};
+};
+
+Message makeMessage(int64_t id) {
+    return Message(id, 1, static_cast<int>(id % 8), id, "benchmark message payload", "bench#0001", "2026-01-01 00:00:00");
+}
+
+struct RunResult {
+    double per_second;
+    uint64_t statements;
+    HistogramSnapshot latency_us;  // 提交到确认落库
+};
+
+// 旧路径: 请求线程自己执行单行INSERT 等返回后才算完成
+RunResult runSync(uint64_t rttUs, uint64_t perRowUs, size_t messages, size_t producers) {
+    StubMessageDao dao(rttUs, perRowUs);
+    Histogram latency;
+    std::atomic<int64_t> nextId{1};
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&]() {
+            std::vector<Message> one(1);
+            for (int64_t id; (id = nextId.fetch_add(1)) <= static_cast<int64_t>(messages);) {
+                one[0] = makeMessage(id);
+                uint64_t submitted = nowUs();
+                dao.insertMessages(one);
+                latency.record(nowUs() - submitted);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return {messages / seconds, dao.statements(), latency.snapshot()};
+}
+
+RunResult runBatched(uint64_t rttUs, uint64_t perRowUs, size_t messages, size_t producers, size_t batchSize) {
+    StubMessageDao dao(rttUs, perRowUs);
+    Histogram latency;
+    std::atomic<size_t> done{0};
+    MessageBatcherConfig config;
+    config.batch_size = batchSize;
+    config.flush_interval_ms = 5;
+    config.max_pending = messages + 1;
+    MessageBatcher batcher([&dao](const std::vector<Message>& batch) {
+        return dao.insertMessages(batch).isSuccess();
+    }, config);
+
+    std::atomic<int64_t> nextId{1};
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&]() {
+            for (int64_t id; (id = nextId.fetch_add(1)) <= static_cast<int64_t>(messages);) {
+                uint64_t submitted = nowUs();
+                batcher.submit(makeMessage(id), [&latency, &done, submitted](bool) {
+                    latency.record(nowUs() - submitted);
+                    done.fetch_add(1, std::memory_order_release);
+                });
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    while (done.load(std::memory_order_acquire) < messages) std::this_thread::sleep_for(std::chrono::microseconds(100));
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    batcher.stop();
+    return {messages / seconds, dao.statements(), latency.snapshot()};
+}
+
+void print(const char* mode, size_t batch, const RunResult& r) {
+    std::printf("%-10s %6zu %14.0f %12llu %12.1f %12.1f\n", mode, batch, r.per_second,
+                static_cast<unsigned long long>(r.statements), r.latency_us.p50 / 1000.0, r.latency_us.p99 / 1000.0);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    uint64_t rttUs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+    uint64_t perRowUs = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2;
+    size_t producers = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 4;
+
+    std::printf("rtt=%lluus per_row=%lluus producers=%zu messages=%zu\n",
+                static_cast<unsigned long long>(rttUs), static_cast<unsigned long long>(perRowUs), producers, messages);
+    std::printf("%-10s %6s %14s %12s %12s %12s\n", "mode", "batch", "messages/s", "statements", "p50 ms", "p99 ms");
+    print("sync", 1, runSync(rttUs, perRowUs, messages, producers));
+    for (size_t batch : {1, 16, 64, 256}) {
+        print("batcher", batch, runBatched(rttUs, perRowUs, messages, producers, batch));
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+// 直接发送基准: 空闲连接上请求到回复的往返延迟
+// direct: 工作线程调用Connection::sendFrame 队列为空时当场sendmsg
+// queued: 工作线程只入队 通知所属事件循环 由循环线程被唤醒后刷新(直接发送之前的路径)
+// 用法: direct_send_bench [轮数=20000] [回复字节数=128]
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "net/Connection.h"
+#include "net/EventLoop.h"
+#include "utils/Histogram.h"
+#include "utils/ThreadPool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+bool readExact(int fd, char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::read(fd, data, len);
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 服务端一侧: 事件循环读到1字节请求后交给工作线程 工作线程回复一帧
+HistogramSnapshot run(bool direct, int rounds, size_t replyBytes) {
+    int pair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) < 0) {
+        std::perror("socketpair");
+        std::exit(2);
+    }
+    ::fcntl(pair[0], F_SETFL, ::fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+    int listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    EventLoop loop(0, listenFd, 100);
+    Connection connection(pair[0]);
+    ThreadPool worker(1);
+    SharedFrame reply = Connection::encodeFrame(1, std::string(replyBytes, 'x'));
+
+    connection.setWriteEventCallback([&loop](int fd, uint32_t generation) { loop.queueFlush(fd, generation); });
+    loop.setFlushHandler([&connection](EventLoop&, int fd, uint32_t) {
+        connection.clearFlushQueued();
+        connection.sendFromWriteBuffer(fd);
+    });
+    loop.getPoller().addFd(pair[0], EPOLLIN);
+    loop.start([&](EventLoop&, const epoll_event& ev) {
+        if (Poller::eventFd(ev) != pair[0]) return;
+        char request;
+        while (::read(pair[0], &request, 1) == 1) {
+            worker.addTask([&connection, &loop, &reply, direct]() {
+                if (direct) {
+                    connection.sendFrame(reply);
+                } else if (connection.queueFrame(reply)) {
+                    loop.queueFlush(connection.getFd(), 0);
+                }
+            });
+        }
+    });
+
+    Histogram latency;
+    std::string response(reply->size(), '\0');
+    for (int i = 0; i < rounds; ++i) {
+        char request = 'r';
+        uint64_t start = nowNs();
+        if (::write(pair[1], &request, 1) != 1 || !readExact(pair[1], response.data(), response.size())) {
+            std::perror("round trip");
+            std::exit(2);
+        }
+        latency.record(nowNs() - start);
+    }
+
+    loop.stop();
+    loop.join();
+    worker.stop();
+    ::close(pair[0]);
+    ::close(pair[1]);
+    return latency.snapshot();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20000;
+    size_t replyBytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 128;
+
+    std::printf("%-8s %12s %12s %12s\n", "mode", "p50 us", "p99 us", "max us");
+    for (bool direct : {false, true}) {
+        auto s = run(direct, rounds, replyBytes);
+        std::printf("%-8s %12.1f %12.1f %12.1f\n", direct ? "direct" : "queued", s.p50 / 1000.0, s.p99 / 1000.0,
+                    s.max / 1000.0);
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// 执行器基准: 对比单队列ThreadPool和WorkStealingPool
+// 投递吞吐(外部线程投递 / 工作线程内扇出)和空闲线程的唤醒延迟 线程数1到64
+// 用法: executor_bench [最大线程数=64] [每轮任务数=1000000]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/Histogram.h"
+#include "utils/ThreadPool.h"
+#include "utils/WorkStealingPool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+std::unique_ptr<Executor> makePool(const std::string& type, size_t threads) {
+    if (type == "work_stealing") return std::make_unique<WorkStealingPool>(threads);
+    return std::make_unique<ThreadPool>(threads);
+}
+
+void waitFor(const std::atomic<size_t>& counter, size_t target) {
+    while (counter.load(std::memory_order_acquire) < target) std::this_thread::yield();
+}
+
+// 与handleReadEvent投递的请求闭包大小相近 放得进Task内部存储
+struct Payload {
+    char bytes[64] = {};
+};
+
+// 单个外部线程连续投递 返回每秒完成的任务数
+double externalSubmit(Executor& pool, size_t tasks) {
+    std::atomic<size_t> done{0};
+    Payload payload;
+    auto start = Clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        pool.addTask([&done, payload]() {
+            (void)payload;
+            done.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    waitFor(done, tasks);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return tasks / seconds;
+}
+
+// 每个工作线程一个种子任务 由它在池内再投递子任务 走工作线程自己的队列
+double internalFanout(Executor& pool, size_t threads, size_t tasks) {
+    std::atomic<size_t> done{0};
+    size_t perSeed = tasks / threads;
+    auto start = Clock::now();
+    for (size_t s = 0; s < threads; ++s) {
+        pool.addTask([&pool, &done, perSeed]() {
+            Payload payload;
+            for (size_t i = 0; i < perSeed; ++i) {
+                pool.addTask([&done, payload]() {
+                    (void)payload;
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+    }
+    waitFor(done, perSeed * threads);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return perSeed * threads / seconds;
+}
+
+// 池空闲(工作线程已睡眠)时投递一个任务 记录从投递到开始执行的时间
+HistogramSnapshot wakeupLatency(Executor& pool, int rounds) {
+    Histogram latency;
+    for (int i = 0; i < rounds; ++i) {
+        // 留出时间让工作线程自旋结束进入睡眠
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        std::atomic<bool> ran{false};
+        uint64_t submitted = nowNs();
+        pool.addTask([&latency, &ran, submitted]() {
+            latency.record(nowNs() - submitted);
+            ran.store(true, std::memory_order_release);
+        });
+        while (!ran.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+    return latency.snapshot();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    size_t tasks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+    constexpr int WAKEUP_ROUNDS = 2000;
+
+    std::printf("%-14s %7s %16s %16s %12s %12s\n",
+                "pool", "threads", "external/s", "fanout/s", "wake p50us", "wake p99us");
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        for (const char* type : {"mutex", "work_stealing"}) {
+            auto pool = makePool(type, threads);
+            double external = externalSubmit(*pool, tasks);
+            double fanout = internalFanout(*pool, threads, tasks);
+            auto wake = wakeupLatency(*pool, WAKEUP_ROUNDS);
+            pool->stop();
+            std::printf("%-14s %7zu %16.0f %16.0f %12.1f %12.1f\n", type, threads, external, fanout,
+                        wake.p50 / 1000.0, wake.p99 / 1000.0);
+        }
+    }
+    return 0;
+}
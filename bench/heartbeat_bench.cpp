@@ -0,0 +1,134 @@
+// 心跳检查基准: 时间轮与每tick全表扫描的单tick开销
+// wheel: 每个连接一个定时器 到期时按最后活跃时间顺延 与ChatRoomServer::checkHeartbeat的做法相同
+// scan: 每个tick遍历全部连接比较最后活跃时间
+// 两者都按真实时钟每10ms推进一次 每个tick随机让一部分连接收到数据 到期未活跃的连接视为发出PING并立即得到回复
+// 首次到期在一个间隔内均匀错开 运行时间短于心跳间隔时测到的也是稳态下每tick的到期数
+// 用法: heartbeat_bench [最大连接数=1000000] [运行秒数=3] [心跳间隔ms=30000(服务端默认)]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "net/TimerWheel.h"
+#include "utils/Histogram.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr uint32_t TICK_MS = 10;
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+struct Result {
+    HistogramSnapshot tick_ns;
+    uint64_t examined = 0;  // 检查过的连接数 时间轮只检查到期的
+    uint64_t pings = 0;
+};
+
+struct Simulation {
+    std::vector<uint64_t> last_active;
+    uint64_t interval_ms;
+    uint64_t pings = 0;
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+    Simulation(size_t connections, uint64_t intervalMs)
+        : last_active(connections, TimerWheel::nowMs()), interval_ms(intervalMs) {}
+
+    // 每个tick约千分之一的连接收到数据
+    void touchSome(uint64_t now) {
+        size_t n = last_active.size() / 1000 + 1;
+        for (size_t i = 0; i < n; ++i) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            last_active[rng % last_active.size()] = now;
+        }
+    }
+};
+
+struct WheelCheck {
+    Simulation* sim;
+    TimerWheel* wheel;
+    size_t index;
+
+    void operator()() const {
+        uint64_t now = TimerWheel::nowMs();
+        uint64_t idle = now - std::min(now, sim->last_active[index]);
+        if (idle >= sim->interval_ms) {
+            ++sim->pings;
+            sim->last_active[index] = now;
+            idle = 0;
+        }
+        wheel->schedule(sim->interval_ms - idle, *this);
+    }
+};
+
+Result runWheel(size_t connections, int seconds, uint64_t intervalMs) {
+    Simulation sim(connections, intervalMs);
+    TimerWheel wheel(TICK_MS);
+    // 首次到期时间在一个间隔内错开 与连接陆续建立的情形相同
+    for (size_t i = 0; i < connections; ++i) {
+        wheel.schedule(intervalMs * (i + 1) / connections, WheelCheck{&sim, &wheel, i});
+    }
+
+    Histogram ticks;
+    uint64_t examined = 0;
+    auto end = Clock::now() + std::chrono::seconds(seconds);
+    while (Clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+        uint64_t now = TimerWheel::nowMs();
+        sim.touchSome(now);
+        uint64_t start = nowNs();
+        examined += wheel.advance(now);
+        ticks.record(nowNs() - start);
+    }
+    return {ticks.snapshot(), examined, sim.pings};
+}
+
+Result runScan(size_t connections, int seconds, uint64_t intervalMs) {
+    Simulation sim(connections, intervalMs);
+    Histogram ticks;
+    uint64_t examined = 0;
+    auto end = Clock::now() + std::chrono::seconds(seconds);
+    while (Clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+        uint64_t now = TimerWheel::nowMs();
+        sim.touchSome(now);
+        uint64_t start = nowNs();
+        examined += sim.last_active.size();
+        for (auto& last : sim.last_active) {
+            if (now - std::min(now, last) >= intervalMs) {
+                ++sim.pings;
+                last = now;
+            }
+        }
+        ticks.record(nowNs() - start);
+    }
+    return {ticks.snapshot(), examined, sim.pings};
+}
+
+void print(const char* mode, size_t connections, const Result& r) {
+    std::printf("%-6s %10zu %12.1f %12.1f %12.1f %14llu %10llu\n", mode, connections, r.tick_ns.p50 / 1000.0,
+                r.tick_ns.p99 / 1000.0, r.tick_ns.max / 1000.0, static_cast<unsigned long long>(r.examined),
+                static_cast<unsigned long long>(r.pings));
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxConnections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    uint64_t intervalMs = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 30000;
+
+    std::printf("%-6s %10s %12s %12s %12s %14s %10s\n", "mode", "conns", "tick p50us", "tick p99us", "tick maxus",
+                "examined", "pings");
+    for (size_t connections = 1000; connections <= maxConnections; connections *= 10) {
+        print("wheel", connections, runWheel(connections, seconds, intervalMs));
+        print("scan", connections, runScan(connections, seconds, intervalMs));
+    }
+    return 0;
+}
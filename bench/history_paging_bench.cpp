@@ -0,0 +1,124 @@
+// 历史消息分页基准: 游标分页(before_message_id)与OFFSET分页在不同页码上的单页延迟
+// 需要真实的MySQL 连接参数读当前目录的.env(与服务端相同) 不要对线上库运行
+// 指定填充条数时先向房间追加这么多条消息(message_id和room_seq接在库中已有的之后) 房间必须已存在
+// 用法: history_paging_bench [房间id=1] [填充条数=0] [每页条数=50] [每个页码重复次数=20]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dao/MySqlMessageDao.h"
+#include "database/DatabaseManager.h"
+#include "utils/EnvLoader.h"
+#include "utils/Histogram.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+}
+
+bool seed(MySqlMessageDao& dao, int roomId, size_t count) {
+    auto maxId = dao.getMaxMessageId();
+    auto sequences = dao.getRoomSequences();
+    if (!maxId.isSuccess() || !sequences.isSuccess()) return false;
+    int64_t lastSeq = 0;
+    for (const auto& [room, seq] : *sequences.data) {
+        if (room == roomId) lastSeq = seq;
+    }
+
+    constexpr size_t BATCH = 1000;
+    int64_t nextId = *maxId.data + 1;
+    std::vector<Message> batch;
+    batch.reserve(BATCH);
+    for (size_t done = 0; done < count;) {
+        batch.clear();
+        for (size_t i = 0; i < BATCH && done < count; ++i, ++done) {
+            batch.emplace_back(nextId++, 1, roomId, ++lastSeq, "history paging benchmark message", "bench#0001",
+                               "2026-01-01 00:00:00");
+        }
+        if (!dao.insertMessages(batch).isSuccess()) return false;
+        if (done % 100000 < BATCH) std::cerr << "seeded " << done << " / " << count << std::endl;
+    }
+    return true;
+}
+
+// 第page页(从1开始)的游标: 上一页最后一条的message_id 第1页为INT64_MAX 不计入计时
+int64_t cursorFor(int roomId, int page, int limit) {
+    if (page == 1) return INT64_MAX;
+    auto result = DatabaseManager::getInstance().execute(
+        "SELECT message_id FROM messages WHERE room_id = ? ORDER BY message_id DESC LIMIT 1 OFFSET ?",
+        roomId, (page - 1) * limit - 1);
+    if (!result.isSuccess()) return -1;
+    return std::stoll(std::get<std::vector<std::string>>(*result.data)[0]);
+}
+
+HistogramSnapshot timeKeyset(MySqlMessageDao& dao, int roomId, int64_t cursor, int limit, int repeats) {
+    Histogram latency;
+    for (int i = 0; i < repeats; ++i) {
+        int rows = 0;
+        uint64_t start = nowUs();
+        dao.streamMessagesBefore(roomId, cursor, limit, [&rows](const Message&) {
+            ++rows;
+            return true;
+        });
+        latency.record(nowUs() - start);
+    }
+    return latency.snapshot();
+}
+
+HistogramSnapshot timeOffset(int roomId, int page, int limit, int repeats) {
+    Histogram latency;
+    for (int i = 0; i < repeats; ++i) {
+        uint64_t start = nowUs();
+        DatabaseManager::getInstance().execute(
+            "SELECT message_id, user_id, room_id, room_seq, content, display_name, send_time "
+            "FROM messages WHERE room_id = ? ORDER BY message_id DESC LIMIT ? OFFSET ?",
+            roomId, limit, (page - 1) * limit);
+        latency.record(nowUs() - start);
+    }
+    return latency.snapshot();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int roomId = argc > 1 ? std::atoi(argv[1]) : 1;
+    size_t seedCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0;
+    int limit = argc > 3 ? std::max(1, std::atoi(argv[3])) : 50;
+    int repeats = argc > 4 ? std::max(1, std::atoi(argv[4])) : 20;
+
+    try {
+        EnvLoader::loadFromFile(".env");
+        DatabaseManager::init();
+    } catch (const std::exception& e) {
+        std::cerr << "database init failed: " << e.what() << std::endl;
+        return 2;
+    }
+
+    MySqlMessageDao dao;
+    if (seedCount > 0 && !seed(dao, roomId, seedCount)) {
+        std::cerr << "seeding failed" << std::endl;
+        return 2;
+    }
+
+    std::printf("%-8s %8s %12s %12s\n", "mode", "page", "p50 ms", "p99 ms");
+    for (int page : {1, 10, 100, 1000, 10000}) {
+        int64_t cursor = cursorFor(roomId, page, limit);
+        if (cursor < 0) {
+            std::printf("room %d has fewer than %d pages\n", roomId, page);
+            break;
+        }
+        auto keyset = timeKeyset(dao, roomId, cursor, limit, repeats);
+        auto offset = timeOffset(roomId, page, limit, repeats);
+        std::printf("%-8s %8d %12.2f %12.2f\n", "keyset", page, keyset.p50 / 1000.0, keyset.p99 / 1000.0);
+        std::printf("%-8s %8d %12.2f %12.2f\n", "offset", page, offset.p50 / 1000.0, offset.p99 / 1000.0);
+    }
+    return 0;
+}
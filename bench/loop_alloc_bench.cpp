@@ -0,0 +1,116 @@
+// 事件循环稳态分配检查: 替换全局operator new计数 只统计循环线程上的分配
+// 预热后驱动N轮迭代(socket可读事件 + 跨线程queueFlush + deferEvent) 期间分配次数必须为0
+// 用法: loop_alloc_bench [迭代数=100000] 有分配时返回1
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include "net/EventLoop.h"
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+thread_local bool t_counting = false;
+
+}
+
+void* operator new(std::size_t size) {
+    if (t_counting) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+int makeListenFd() {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        std::perror("listen");
+        std::exit(2);
+    }
+    return fd;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    constexpr uint64_t WARMUP = 1000;
+
+    int pair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, pair) < 0) {
+        std::perror("socketpair");
+        return 2;
+    }
+
+    EventLoop loop(0, makeListenFd(), 100);
+    loop.getPoller().addFd(pair[0], EPOLLIN, 7);
+
+    std::atomic<uint64_t> handled{0};
+    std::atomic<uint64_t> flushed{0};
+    loop.setFlushHandler([&flushed](EventLoop&, int, uint32_t) {
+        flushed.fetch_add(1, std::memory_order_relaxed);
+    });
+    loop.start([&](EventLoop& l, const epoll_event& ev) {
+        if (Poller::eventFd(ev) != pair[0]) return;
+        // 只读一个字节 剩余数据通过deferEvent留到下一轮 走交换数组的路径
+        char byte;
+        if (::read(pair[0], &byte, 1) == 1) {
+            l.deferEvent(ev);
+            return;
+        }
+        uint64_t n = handled.fetch_add(1, std::memory_order_relaxed) + 1;
+        t_counting = n > WARMUP;
+    });
+
+    char bytes[2] = {'a', 'b'};
+    for (uint64_t i = 0; i < WARMUP + iterations; ++i) {
+        loop.queueFlush(pair[0], 7);
+        if (::write(pair[1], bytes, sizeof(bytes)) != sizeof(bytes)) {
+            std::perror("write");
+            return 2;
+        }
+        while (handled.load(std::memory_order_relaxed) <= i) std::this_thread::yield();
+    }
+
+    loop.stop();
+    loop.join();
+
+    LoopStats stats = loop.getStats();
+    uint64_t allocations = g_allocations.load();
+    std::printf("iterations=%llu flushes=%llu loop_iterations=%llu allocations=%llu\n",
+                static_cast<unsigned long long>(iterations), static_cast<unsigned long long>(flushed.load()),
+                static_cast<unsigned long long>(stats.iterations), static_cast<unsigned long long>(allocations));
+    ::close(pair[0]);
+    ::close(pair[1]);
+    return allocations == 0 ? 0 : 1;
+}
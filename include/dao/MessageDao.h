@@ -1,5 +1,7 @@
 #pragma once
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 #include "models/Message.h"
 #include "utils/QueryResult.h"
@@ -8,7 +10,18 @@ class MessageDao {
 public:
     virtual ~MessageDao() = default;
     
-    virtual QueryResult<void> sendMessageToRoom(int userId, int roomId, const std::string& content, const std::string& displayName, const std::string& sendTime) = 0;
     virtual QueryResult<std::vector<Message>> getRecentMessages(int roomId, int max_count = 50) = 0;
     virtual QueryResult<std::vector<Message>> getRecentMessagesByUser(int userId, int roomId, int max_count = 50) = 0;
+    // 一条多行INSERT写入一批消息 message_id由调用方分配
+    // 库中已有的message_id视为之前的重试已写入 其余冲突(如room_seq重复)返回错误 不会被吞掉
+    virtual QueryResult<void> insertMessages(const std::vector<Message>& messages) = 0;
+    // 取得消息写入者锁并一直持有 room_seq在单个进程的内存里分配 同一个库只能有一个写入者
+    // 返回false表示锁已被别的实例持有
+    virtual QueryResult<bool> acquireWriterLock() = 0;
+    virtual QueryResult<int64_t> getMaxMessageId() = 0;
+    // 每个房间已用到的最大room_seq
+    virtual QueryResult<std::vector<std::pair<int, int64_t>>> getRoomSequences() = 0;
+    // 按message_id倒序逐条取出房间里id小于beforeMessageId的消息 最多limit条 走(room_id, message_id)索引
+    virtual QueryResult<void> streamMessagesBefore(int roomId, int64_t beforeMessageId, int limit,
+                                                   const std::function<bool(const Message&)>& onMessage) = 0;
 }; 
\ No newline at end of file
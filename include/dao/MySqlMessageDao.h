@@ -7,9 +7,22 @@ class MySqlMessageDao : public MessageDao, public SqlDao<Message> {
 public:
     ~MySqlMessageDao() override = default;
 
-    QueryResult<void> sendMessageToRoom(int userId, int roomId, const std::string& content, const std::string& displayName, const std::string& sendTime) override;
     QueryResult<std::vector<Message>> getRecentMessages(int roomId, int max_count = 50) override;
     QueryResult<std::vector<Message>> getRecentMessagesByUser(int userId, int roomId, int max_count = 50) override;
+    QueryResult<void> insertMessages(const std::vector<Message>& messages) override;
+    QueryResult<bool> acquireWriterLock() override;
+    QueryResult<int64_t> getMaxMessageId() override;
+    QueryResult<std::vector<std::pair<int, int64_t>>> getRoomSequences() override;
+    QueryResult<void> streamMessagesBefore(int roomId, int64_t beforeMessageId, int limit,
+                                           const std::function<bool(const Message&)>& onMessage) override;
 protected:
     Message createFromResultSet(const std::vector<std::string>& row) override;
+
+private:
+    QueryResult<ExecuteResult> insertRows(const std::vector<Message>& messages);
+    // 批中已在库里的message_id
+    QueryResult<std::vector<int64_t>> findExistingIds(const std::vector<Message>& messages);
+
+    // GET_LOCK属于会话 持有锁的连接不还给连接池
+    std::shared_ptr<DatabaseConnection> writer_connection_;
 };
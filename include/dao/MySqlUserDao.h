@@ -14,6 +14,7 @@ public:
     QueryResult<void> changeDisplayName(int user_id, const std::string& new_name) override;
     
     QueryResult<User> authenticateUser(const std::string& email, const std::string& password) override;
+    QueryResult<UserCredentials> getUserCredentials(const std::string& email) override;
     
     QueryResult<User> getUserById(int id) override;
     QueryResult<User> getUserByEmail(const std::string& email) override;
@@ -21,6 +21,10 @@ public:
         return DatabaseManager::getInstance().execute(conn, sql, args...);
     }
     
+    QueryResult<void> stream(const std::string& sql, const std::vector<SqlParam>& params, const RowCallback& onRow) {
+        return DatabaseManager::getInstance().stream(sql, params, onRow);
+    }
+
     template<typename Func>
     QueryResult<ExecuteResult> executeTransaction(Func&& func) {
         return DatabaseManager::getInstance().executeTransaction(std::forward<Func>(func));
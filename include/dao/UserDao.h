@@ -11,6 +11,8 @@ public:
     virtual QueryResult<void> changePassword(const std::string& email, const std::string& old_password, const std::string& new_password) = 0;
     virtual QueryResult<void> changeDisplayName(int user_id, const std::string& new_name) = 0;
     virtual QueryResult<User> authenticateUser(const std::string& email, const std::string& password) = 0;
+    // 只查询不校验密码 用户不存在时NotFound
+    virtual QueryResult<UserCredentials> getUserCredentials(const std::string& email) = 0;
     virtual QueryResult<User> getUserById(int id) = 0;
     virtual QueryResult<User> getUserByEmail(const std::string& email) = 0;
     virtual QueryResult<User> getUserByFullName(const std::string& name, const std::string& discriminator) = 0;
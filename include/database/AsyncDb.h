@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "utils/Executor.h"
+
+struct AsyncDbStats {
+    size_t threads;
+    uint64_t in_flight;       // 已提交尚未返回的数据库调用
+    uint64_t peak_in_flight;
+    uint64_t completed;
+    ExecutorStats pool;
+};
+
+// 可co_await的数据库调用
+// MySQL的预处理语句没有非阻塞接口 所以阻塞调用放到一组专用的数据库I/O线程上执行
+// 发起调用的协程挂起 原工作线程回去处理别的请求 调用返回后协程回到原执行器继续
+// 用法: auto result = co_await asyncDb.run([&] { return service->fetchLoginCredentials(email); });
+// 传入的函数只应做数据库访问 耗CPU的计算(如密码哈希)放回调用方的执行器上做
+class AsyncDb {
+public:
+    explicit AsyncDb(std::unique_ptr<Executor> ioExecutor);
+    ~AsyncDb();
+
+    AsyncDb(const AsyncDb&) = delete;
+    AsyncDb& operator=(const AsyncDb&) = delete;
+
+    template<typename Func>
+    class Awaitable;
+
+    template<typename Func>
+    Awaitable<Func> run(Func func) { return Awaitable<Func>(*this, std::move(func)); }
+
+    void stop();
+    AsyncDbStats getStats() const;
+
+private:
+    void onSubmit();
+    void onComplete();
+
+    std::unique_ptr<Executor> io_;
+    std::atomic<uint64_t> in_flight_{0};
+    std::atomic<uint64_t> peak_in_flight_{0};
+    std::atomic<uint64_t> completed_{0};
+};
+
+template<typename Func>
+class AsyncDb::Awaitable {
+public:
+    using Result = std::invoke_result_t<Func&>;
+
+    Awaitable(AsyncDb& db, Func func) : db_(db), func_(std::move(func)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        // 记住挂起前所在的执行器 不在执行器线程上时直接在I/O线程恢复
+        Executor* resumeOn = Executor::current();
+        db_.onSubmit();
+        db_.io_->addTask([this, h, resumeOn]() {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    func_();
+                    result_.emplace();
+                } else {
+                    result_.emplace(func_());
+                }
+            } catch (...) {
+                exception_ = std::current_exception();
+            }
+            db_.onComplete();
+            Executor::resume(resumeOn, h);
+        });
+    }
+
+    Result await_resume() {
+        if (exception_) std::rethrow_exception(exception_);
+        if constexpr (!std::is_void_v<Result>) return std::move(*result_);
+    }
+
+private:
+    using Storage = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+    AsyncDb& db_;
+    Func func_;
+    std::optional<Storage> result_;
+    std::exception_ptr exception_;
+};
@@ -2,12 +2,21 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstdint>
 #include <cstring>
+#include <functional>
+#include <variant>
 #include <mysql/mysql.h>
 #include "utils/QueryResult.h"
 #include "database/ExecuteResult.h"
 
 class DatabaseConnection;
+class PreparedStatement;
+
+// 运行时才确定个数的参数 用于多行INSERT这类语句
+using SqlParam = std::variant<int, int64_t, double, std::string>;
+// 逐行处理查询结果 返回false提前结束
+using RowCallback = std::function<bool(const std::vector<std::string>&)>;
 
 class DatabaseManager {
 private:
@@ -36,10 +45,21 @@ public:
     template<typename... Args>
     QueryResult<ExecuteResult> execute(std::shared_ptr<DatabaseConnection> conn, const std::string& sql, Args... args);
     
+    QueryResult<ExecuteResult> execute(const std::string& sql, const std::vector<SqlParam>& params);
+    QueryResult<ExecuteResult> execute(std::shared_ptr<DatabaseConnection> conn, const std::string& sql, const std::vector<SqlParam>& params);
+
+    // 不缓存整个结果集 每取到一行就交给onRow 行数多或单行很大时不需要一次性持有全部结果
+    QueryResult<void> stream(const std::string& sql, const std::vector<SqlParam>& params, const RowCallback& onRow);
+
     template<typename Func>
     QueryResult<ExecuteResult> executeTransaction(Func&& func);
     
     ~DatabaseManager() = default;
+
+private:
+    // 执行已绑定参数的语句并取回结果
+    static QueryResult<ExecuteResult> executeStatement(PreparedStatement& stmt);
+    static QueryResult<void> streamStatement(PreparedStatement& stmt, const RowCallback& onRow);
 };
 
 #include "database/DatabaseManager.inl" 
\ No newline at end of file
@@ -35,91 +35,7 @@ QueryResult<ExecuteResult> DatabaseManager::execute(std::shared_ptr<DatabaseConn
         
         (stmt->bind(args), ...);
         
-        if (!stmt->execute()) {
-            std::string error_msg = stmt->getLastError();
-            if (error_msg.empty()) {
-                error_msg = "Failed to execute SQL statement";
-            }
-            return QueryResult<ExecuteResult>::InternalError(error_msg);
-        }
-        
-        MYSQL_RES* meta_result = mysql_stmt_result_metadata(stmt->getStmt());
-        if (!meta_result) {
-            return QueryResult<ExecuteResult>::Success(std::monostate{});
-        }
-        
-        int column_count = mysql_num_fields(meta_result);
-        if (column_count == 0) {
-            mysql_free_result(meta_result);
-            return QueryResult<ExecuteResult>::Success(std::monostate{});
-        }
-        
-        if (mysql_stmt_store_result(stmt->getStmt()) != 0) {
-            mysql_free_result(meta_result);
-            return QueryResult<ExecuteResult>::InternalError("Failed to store result");
-        }
-        
-        my_ulonglong row_count = mysql_stmt_num_rows(stmt->getStmt());
-        
-        std::vector<MYSQL_BIND> result_binds(column_count);
-        std::vector<std::string> string_buffers(column_count);
-        std::vector<unsigned long> lengths(column_count);
-        
-        memset(result_binds.data(), 0, sizeof(MYSQL_BIND) * column_count);
-        
-        const size_t initial_buffer_size = 1024;
-        
-        for (int i = 0; i < column_count; ++i) {
-            string_buffers[i].resize(initial_buffer_size);
-            result_binds[i].buffer_type = MYSQL_TYPE_STRING;
-            result_binds[i].buffer = string_buffers[i].data();
-            result_binds[i].buffer_length = initial_buffer_size;
-            result_binds[i].length = &lengths[i];
-        }
-        
-        mysql_free_result(meta_result);
-        
-        if (mysql_stmt_bind_result(stmt->getStmt(), result_binds.data()) != 0) {
-            return QueryResult<ExecuteResult>::InternalError("Failed to bind result");
-        }
-        
-        if (row_count == 0) {
-            return QueryResult<ExecuteResult>::NotFound();
-        } else if (row_count == 1) {
-            int fetch_result = mysql_stmt_fetch(stmt->getStmt());
-            if (fetch_result != 0) {
-                return QueryResult<ExecuteResult>::InternalError("Failed to fetch single row");
-            }
-            
-            std::vector<std::string> row;
-            row.reserve(column_count);
-            for (int i = 0; i < column_count; ++i) {
-                row.emplace_back(string_buffers[i].data(), lengths[i]);
-            }
-            
-            return QueryResult<ExecuteResult>::Success(row);
-        } else {
-            std::vector<std::vector<std::string>> results;
-            
-            while (true) {
-                int fetch_result = mysql_stmt_fetch(stmt->getStmt());
-                if (fetch_result == 0) {
-                    std::vector<std::string> row;
-                    row.reserve(column_count);
-                    for (int i = 0; i < column_count; ++i) {
-                        row.emplace_back(string_buffers[i].data(), lengths[i]);
-                    }
-                    results.push_back(std::move(row));
-                } else if (fetch_result == MYSQL_NO_DATA) {
-                    break;
-                } else {
-                    return QueryResult<ExecuteResult>::InternalError("Failed to fetch rows");
-                }
-            }
-            
-            return QueryResult<ExecuteResult>::Success(results);
-        }
-        
+        return executeStatement(*stmt);
     } catch (const std::exception& e) {
         return QueryResult<ExecuteResult>::InternalError(std::string("Exception: ") + e.what());
     }
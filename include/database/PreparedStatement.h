@@ -1,5 +1,6 @@
 #pragma once
 #include <mysql/mysql.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <variant>
@@ -12,9 +13,11 @@ public:
     ~PreparedStatement();
 
     PreparedStatement& bind(int value);
+    PreparedStatement& bind(int64_t value);
     PreparedStatement& bind(const std::string& value);
     PreparedStatement& bind(double value);
     PreparedStatement& bind(bool value);
+    PreparedStatement& bind(const std::variant<int, int64_t, double, std::string>& value);
 
     bool execute();
     std::string getLastError() const;
@@ -24,6 +27,6 @@ private:
     std::shared_ptr<DatabaseConnection> connection_;
     MYSQL_STMT* stmt_;
     std::vector<MYSQL_BIND> param_binds_;
-    std::vector<std::variant<int, double, std::string>> param_values_;
+    std::vector<std::variant<int, int64_t, double, std::string>> param_values_;
     size_t current_param_idx_;
 };
\ No newline at end of file
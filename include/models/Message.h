@@ -1,18 +1,20 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 struct Message {
-    int message_id = 0;
+    int64_t message_id = 0;  // 服务端生成的Snowflake id 全局递增
     int user_id = 0;
     int room_id = 0;
+    int64_t room_seq = 0;    // 房间内从1开始连续递增 客户端据此发现漏收的消息
     std::string content;
     std::string display_name;
     std::string send_time;
     
     Message() = default;
     
-    Message(int mid, int uid, int rid, const std::string& cont, 
+    Message(int64_t mid, int uid, int rid, int64_t seq, const std::string& cont,
             const std::string& name, const std::string& send_time)
-        : message_id(mid), user_id(uid), room_id(rid), content(cont), 
+        : message_id(mid), user_id(uid), room_id(rid), room_seq(seq), content(cont),
           display_name(name), send_time(send_time) {}
 }; 
\ No newline at end of file
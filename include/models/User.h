@@ -13,4 +13,10 @@ struct User {
     
     User(int id, const std::string& discriminator, const std::string& name, const std::string& email, bool is_admin, const std::string& created_time)
         : id(id), discriminator(discriminator), name(name), email(email), is_admin(is_admin), created_time(created_time) {}
-}; 
\ No newline at end of file
+};
+
+// 登录时查出的用户和密码哈希 密码校验在数据库线程之外进行
+struct UserCredentials {
+    User user;
+    std::string password_hash;
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "net/WriteQueue.h"
+
+// 慢消费者的处理策略 在连接发送队列超过高水位后生效 直到回落到低水位
+enum class BackpressurePolicy {
+    DropOldest,   // 丢弃最旧的可丢弃推送
+    Coalesce,     // 同类型的状态推送只保留最新一条 其余推送按DropOldest处理
+    Disconnect,   // 发送通知后断开连接
+};
+
+// 帧的重要程度 由上层按消息类型划分
+enum class FrameClass {
+    Essential,    // 请求的回复等 不丢弃
+    Droppable,    // 普通推送 拥塞时可丢弃
+    Coalescable,  // 状态类推送 新的一条可以覆盖旧的
+};
+
+struct BackpressureConfig {
+    size_t high_watermark = 256 * 1024;
+    size_t low_watermark = 64 * 1024;
+    size_t hard_limit = 1024 * 1024;           // 单连接上限 必需帧也放不下时直接断开
+    size_t memory_budget = 256 * 1024 * 1024;  // 所有连接发送队列的总字节数上限
+    BackpressurePolicy policy = BackpressurePolicy::DropOldest;
+    FrameClass (*classify)(uint16_t type) = nullptr;  // 为空时所有帧都视为必需
+    SharedFrame disconnect_notice;                    // 断开前尽力发送的通知帧
+};
+
+struct BackpressureStats {
+    uint64_t queued_bytes;
+    uint64_t congestion_events;
+    uint64_t dropped_frames;
+    uint64_t dropped_bytes;
+    uint64_t coalesced_frames;
+    uint64_t budget_rejections;
+    uint64_t disconnects;
+};
+
+// 全局共享 各连接在自己的锁内调用 这里只有原子计数
+class BackpressureController {
+public:
+    explicit BackpressureController(BackpressureConfig config);
+
+    const BackpressureConfig& config() const { return config_; }
+    FrameClass classify(uint16_t type) const {
+        return config_.classify ? config_.classify(type) : FrameClass::Essential;
+    }
+    bool overBudget(size_t extra) const {
+        return queued_bytes_.load(std::memory_order_relaxed) + extra > config_.memory_budget;
+    }
+
+    void addQueued(int64_t delta) { queued_bytes_.fetch_add(delta, std::memory_order_relaxed); }
+    void recordCongestion() { congestion_events_.fetch_add(1, std::memory_order_relaxed); }
+    void recordDropped(size_t frames, size_t bytes);
+    void recordCoalesced(size_t frames, size_t bytes);
+    void recordBudgetRejection() { budget_rejections_.fetch_add(1, std::memory_order_relaxed); }
+    void recordDisconnect() { disconnects_.fetch_add(1, std::memory_order_relaxed); }
+
+    BackpressureStats getStats() const;
+
+    // "drop_oldest" / "coalesce" / "disconnect"
+    static std::optional<BackpressurePolicy> parsePolicy(const std::string& name);
+    static const char* policyName(BackpressurePolicy policy);
+
+private:
+    BackpressureConfig config_;
+    std::atomic<int64_t> queued_bytes_{0};
+    std::atomic<uint64_t> congestion_events_{0};
+    std::atomic<uint64_t> dropped_frames_{0};
+    std::atomic<uint64_t> dropped_bytes_{0};
+    std::atomic<uint64_t> coalesced_frames_{0};
+    std::atomic<uint64_t> budget_rejections_{0};
+    std::atomic<uint64_t> disconnects_{0};
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Buffer的底层存储 slices为仍引用它的BufferSlice个数
+// shared_ptr只管释放 Buffer判断能否原地复用看slices:
+// 切片在别的线程析构时以release递减 Buffer以acquire读取 读到0时对方的读取都已完成
+struct BufferStorage {
+    explicit BufferStorage(size_t size) : bytes(new char[size]) {}
+
+    std::atomic<int> slices{0};
+    std::unique_ptr<char[]> bytes;
+};
+
+// 对Buffer中一段已读出数据的引用 与Buffer共享底层存储 拷贝只增加引用计数
+class BufferSlice {
+public:
+    BufferSlice() = default;
+    BufferSlice(std::shared_ptr<BufferStorage> storage, const char* data, size_t len)
+        : storage_(std::move(storage)), data_(data), len_(len) {
+        acquire();
+    }
+    BufferSlice(const BufferSlice& other)
+        : storage_(other.storage_), data_(other.data_), len_(other.len_) {
+        acquire();
+    }
+    BufferSlice(BufferSlice&& other) noexcept
+        : storage_(std::move(other.storage_)), data_(other.data_), len_(other.len_) {
+        other.data_ = nullptr;
+        other.len_ = 0;
+    }
+    BufferSlice& operator=(BufferSlice other) noexcept {
+        std::swap(storage_, other.storage_);
+        std::swap(data_, other.data_);
+        std::swap(len_, other.len_);
+        return *this;
+    }
+    ~BufferSlice() { release(); }
+
+    const char* data() const { return data_; }
+    size_t size() const { return len_; }
+    bool empty() const { return len_ == 0; }
+    std::string_view view() const { return std::string_view(data_, len_); }
+    std::string str() const { return std::string(data_, len_); }
+
+private:
+    // 新切片总是从已有引用(Buffer或另一个切片)派生 计数不会从0被别的线程加上去 relaxed即可
+    void acquire() {
+        if (storage_) storage_->slices.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release() {
+        if (storage_) storage_->slices.fetch_sub(1, std::memory_order_release);
+    }
+
+    std::shared_ptr<BufferStorage> storage_;
+    const char* data_ = nullptr;
+    size_t len_ = 0;
+};
+
+// 带读写下标的可增长缓冲区
+// 读出数据只移动读下标 只有在尾部空间不足时才整理或扩容
+// 若仍有BufferSlice引用当前存储 则换用新存储而不是原地搬移 只拷贝未读部分
+class Buffer {
+public:
+    explicit Buffer(size_t initialSize = 4096);
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    Buffer(Buffer&&) = default;
+    Buffer& operator=(Buffer&&) = default;
+
+    size_t readableBytes() const { return write_index_ - read_index_; }
+    size_t writableBytes() const { return capacity_ - write_index_; }
+    bool empty() const { return readableBytes() == 0; }
+
+    const char* peek() const { return storage_->bytes.get() + read_index_; }
+    char* beginWrite() { return storage_->bytes.get() + write_index_; }
+
+    void ensureWritable(size_t len);
+    void hasWritten(size_t len) { write_index_ += len; }
+    void append(const char* data, size_t len);
+    void append(std::string_view data) { append(data.data(), data.size()); }
+
+    void retrieve(size_t len);
+    void retrieveAll();
+    // 读出len字节 返回零拷贝的切片
+    BufferSlice retrieveAsSlice(size_t len);
+
+    void clear();
+
+private:
+    void makeSpace(size_t len);
+    bool isShared() const { return storage_->slices.load(std::memory_order_acquire) > 0; }
+
+    std::shared_ptr<BufferStorage> storage_;
+    size_t capacity_;
+    size_t initial_size_;
+    size_t read_index_;
+    size_t write_index_;
+};
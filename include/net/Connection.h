@@ -1,10 +1,15 @@
 #pragma once
 #include <string>
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <vector>
 #include <functional>
-
+#include <string_view>
+#include "net/Buffer.h"
+#include "net/Backpressure.h"
+#include "net/WriteQueue.h"
+#include "utils/Strand.h"
 
 struct SendResult {
     ssize_t bytes_sent;
@@ -18,19 +23,20 @@ struct ReadResult {
     bool connection_closed;
 };
 
+// data是读缓冲区中消息体的切片 处理函数直接在其上解析 不再拷贝
 struct NetworkMessage {
     uint16_t type;
     uint16_t length;
-    std::string data;
+    BufferSlice data;
     
     NetworkMessage() : type(0), length(0) {}
-    NetworkMessage(uint16_t t, const std::string& d) 
-        : type(t), length(d.length()), data(d) {}
+    NetworkMessage(uint16_t t, BufferSlice d) 
+        : type(t), length(d.size()), data(std::move(d)) {}
 };
 
 class Connection {
 public:
-    explicit Connection(int fd);
+    explicit Connection(int fd, int loopIndex = 0);
     ~Connection();
     
     Connection(const Connection&) = delete;
@@ -39,16 +45,79 @@ public:
     Connection& operator=(Connection&&) = default;
     
     int getFd() const { return fd_; }
+    int getLoopIndex() const { return loop_index_; }
+    // 该连接的请求都投递到这个Strand 保证按到达顺序逐个处理
+    const std::shared_ptr<Strand>& getStrand() const { return strand_; }
+    void setStrand(std::shared_ptr<Strand> strand) { strand_ = std::move(strand); }
+
+    // 由ConnectionTable在放入时分配 用于识别fd复用
+    uint32_t getGeneration() const { return generation_; }
+    void setGeneration(uint32_t generation) { generation_ = generation; }
+
+    // 登录会话 在工作线程登录/断开时写 校验令牌时在任意线程读 未登录时用户为-1
+    int getUserId() const { return user_id_.load(std::memory_order_acquire); }
+    // 返回之前会话的令牌编号(没有为0) 供调用方吊销
+    uint64_t setSession(int userId, uint64_t tokenId) {
+        user_id_.store(userId, std::memory_order_release);
+        return token_id_.exchange(tokenId, std::memory_order_acq_rel);
+    }
+    uint64_t clearSession() {
+        display_name_.store(nullptr, std::memory_order_release);
+        return setSession(-1, 0);
+    }
+    // 会话缓存的显示名(name#discriminator) 登录时写入 改名后刷新 为空表示需要从数据库读取
+    std::shared_ptr<const std::string> getDisplayName() const { return display_name_.load(std::memory_order_acquire); }
+    void setDisplayName(std::shared_ptr<const std::string> name) { display_name_.store(std::move(name), std::memory_order_release); }
+
+    // 心跳状态 只在所属事件循环线程中访问 时间为TimerWheel::nowMs()
+    uint64_t getLastActiveMs() const { return last_active_ms_; }
+    void touch(uint64_t nowMs) { last_active_ms_ = nowMs; }
+    uint64_t getPingSentMs() const { return ping_sent_ms_; }
+    void setPingSentMs(uint64_t ms) { ping_sent_ms_ = ms; }
+
+    // 自适应读取大小 只在所属事件循环线程中访问
+    size_t getReadSize() const { return read_size_; }
+    void adaptReadSize(size_t lastRead, size_t eventTotal);
     
+    // 编码一次 得到的帧可以投递给任意多个连接 消息体过长时返回nullptr
+    static SharedFrame encodeFrame(uint16_t type, std::string_view data);
+
     std::vector<NetworkMessage> extractMessages();
     void appendToWriteBuffer(const std::string& data);
+
+    // 设置后发送队列受高低水位和全局预算约束 按策略需要断开时队列里只留断开通知 进入关闭中状态
+    void setBackpressure(BackpressureController* controller);
     
-    SendResult sendFromWriteBuffer(int fd, size_t maxLen);
+    // 一次writev提交多帧 持续发送直到队列清空或EAGAIN
+    SendResult sendFromWriteBuffer(int fd);
     ReadResult recvToReadBuffer(int fd, size_t maxLen);
 
     void sendMessage(uint16_t type, const std::string& data);
-    void setWriteEventCallback(std::function<void(int)> callback);
+    // 队列为空时先在调用线程直接发送 发不完才通过回调通知所属事件循环刷新
+    // 回调在两次刷新之间最多触发一次
+    void sendFrame(const SharedFrame& frame);
+    // 只入队不发送 供调用方在持有别的锁时使用 返回true时需在释放锁后调用flushQueued
+    bool queueFrame(const SharedFrame& frame);
+    // 在调用线程尝试非阻塞发送已入队的帧 发不完再通知所属事件循环
+    void flushQueued();
+    // 回调参数为(fd, generation)
+    void setWriteEventCallback(std::function<void(int, uint32_t)> callback);
+
+    // 事件循环取走刷新请求时调用 之后再入队的帧会重新触发回调
+    void clearFlushQueued() { flush_queued_.store(false, std::memory_order_release); }
+    // 是否已注册EPOLLOUT 只在所属事件循环线程中访问
+    bool isWriteArmed() const { return write_armed_; }
+    void setWriteArmed(bool armed) { write_armed_ = armed; }
         
+    // 关闭fd之前调用 之后任何线程都不会再对fd_做I/O 此前已开始的发送在返回前完成
+    void markClosed();
+    // 可在任意线程调用 不再接受新的帧 notice(可为空)排在队尾 由所属事件循环写完队列后关闭连接
+    void closeAfterFlush(const SharedFrame& notice);
+    bool isClosing() const { return closing_.load(std::memory_order_acquire); }
+    // 关闭中的连接是否已设置写完超时 只在所属事件循环线程中访问
+    bool isDrainTimerArmed() const { return drain_timer_armed_; }
+    void setDrainTimerArmed(bool armed) { drain_timer_armed_ = armed; }
+    
     void lock() { mutex_.lock(); }
     void unlock() { mutex_.unlock(); }
     
@@ -56,12 +125,40 @@ private:
     static constexpr size_t HEADER_SIZE = 4;
     static constexpr size_t MAX_MESSAGE_LENGTH = 65536;
     static constexpr size_t MAX_READ_BUFFER_SIZE  = 1024 * 1024;
-    static constexpr size_t MAX_WRITE_BUFFER_SIZE = 1024 * 1024;
+    static constexpr size_t MIN_READ_SIZE = 1024;
+    static constexpr size_t INITIAL_READ_SIZE = 4096;
+    static constexpr size_t MAX_READ_SIZE = 65536;
     
     int fd_;
-    std::string read_buffer_;
-    std::string write_buffer_;
+    int loop_index_;
+    uint32_t generation_ = 0;
+    std::atomic<int> user_id_{-1};
+    std::atomic<uint64_t> token_id_{0};
+    std::atomic<std::shared_ptr<const std::string>> display_name_;
+    std::shared_ptr<Strand> strand_;
+    size_t read_size_ = INITIAL_READ_SIZE;
+    uint64_t last_active_ms_;
+    uint64_t ping_sent_ms_ = 0;  // 0表示没有未回应的PING
+    bool write_armed_ = false;
+    bool drain_timer_armed_ = false;
+    std::atomic<bool> flush_queued_{false};
+    Buffer read_buffer_;
+    WriteQueue write_queue_;
     mutable std::mutex mutex_;
     
-    std::function<void(int)> write_callback_;
+    std::function<void(int, uint32_t)> write_callback_;
+
+    // 以下由mutex_保护
+    BackpressureController* backpressure_ = nullptr;
+    size_t accounted_bytes_ = 0;  // 已计入全局预算的字节数
+    bool congested_ = false;
+    std::atomic<bool> closing_{false};   // 只在持有mutex_时写 读方不加锁
+    bool closed_ = false;   // fd已经或即将被关闭 可能被新连接复用
+
+    // 判断帧能否入队 必要时按策略丢弃旧帧或标记断开 调用时需持有mutex_
+    bool admitFrame(const SharedFrame& frame, bool& closing);
+    // 通知所属事件循环刷新 两次刷新之间最多通知一次
+    void requestFlush();
+    // 把发送队列字节数的变化同步到全局预算 调用时需持有mutex_
+    void accountQueuedBytes();
 }; 
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "net/Connection.h"
+
+// 以fd为下标的连接表 没有全局锁 查找是一次边界检查 一次读块指针 再读一次槽
+// 槽按CHUNK_SIZE个一块 第一次有fd落进某块时才分配 块分配后直到析构都不释放 读方拿到的块指针一直有效
+// 槽里是std::atomic<std::shared_ptr> libstdc++用控制块指针上的一个锁位实现它 不是无锁的
+// 但这把锁只属于这一个槽 不同fd之间互不等待
+// 每个槽有自增的generation 写入连接时分配 用来识别fd被关闭后又被新连接复用
+class ConnectionTable {
+public:
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    // capacity为0时取RLIMIT_NOFILE(最多2^20)
+    explicit ConnectionTable(size_t capacity = 0);
+    ~ConnectionTable();
+
+    ConnectionTable(const ConnectionTable&) = delete;
+    ConnectionTable& operator=(const ConnectionTable&) = delete;
+
+    // fd超出容量时返回false 成功时给connection分配新的generation
+    bool insert(int fd, const std::shared_ptr<Connection>& connection);
+    std::shared_ptr<Connection> get(int fd) const;
+    // generation不符(fd已被复用)时返回空
+    std::shared_ptr<Connection> get(int fd, uint32_t generation) const;
+    // 只有槽里仍是该generation的连接时才移除并返回它 并发移除同一个连接时只有一方拿到
+    std::shared_ptr<Connection> remove(int fd, uint32_t generation);
+    void clear();
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return capacity_; }
+    // 已分配的槽数 用于观察内存占用
+    size_t allocatedSlots() const { return allocated_chunks_.load(std::memory_order_relaxed) * CHUNK_SIZE; }
+
+private:
+    struct Slot {
+        std::atomic<std::shared_ptr<Connection>> connection;
+        std::atomic<uint32_t> next_generation{1};
+    };
+
+    // 不分配 块不存在时返回nullptr
+    Slot* find(int fd) const;
+    Slot* findOrCreate(int fd);
+
+    size_t capacity_;
+    size_t chunk_count_;
+    std::unique_ptr<std::atomic<Slot*>[]> chunks_;
+    std::mutex grow_mutex_;
+    std::atomic<size_t> allocated_chunks_{0};
+    std::atomic<size_t> size_{0};
+};
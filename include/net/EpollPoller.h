@@ -1,20 +1,23 @@
 #pragma once
 #include <sys/epoll.h>
 #include <vector>
+#include "net/Poller.h"
 
-class EpollPoller {
+class EpollPoller : public Poller {
 public:
     explicit EpollPoller(int maxEvents = 1024);
-    ~EpollPoller();
-    bool addFd(int fd, uint32_t events);
-    bool modifyFd(int fd, uint32_t events);
-    bool removeFd(int fd);
-    std::vector<epoll_event> poll(int timeoutMs = -1);
-    
-    void modFd(int fd, uint32_t events) { modifyFd(fd, events); }
-    void delFd(int fd) { removeFd(fd); }
+    ~EpollPoller() override;
+    bool addFd(int fd, uint32_t events, uint32_t tag = 0) override;
+    bool modifyFd(int fd, uint32_t events, uint32_t tag = 0) override;
+    bool removeFd(int fd) override;
+    std::span<const epoll_event> poll(int timeoutMs = -1) override;
+    const char* name() const override { return "epoll"; }
 
 private:
     int epfd_;
     std::vector<epoll_event> events_;
+    bool grow_ = false;
+
+    // epoll_wait填满数组时翻倍 直到上限
+    static constexpr size_t MAX_EVENTS_CAPACITY = 65536;
 };
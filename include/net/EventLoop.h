@@ -0,0 +1,98 @@
+#pragma once
+#include <sys/epoll.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "net/Poller.h"
+#include "net/TimerWheel.h"
+
+// 事件循环统计 last_*为最近一轮迭代 其余为累计值 时间单位微秒
+struct LoopStats {
+    uint64_t iterations = 0;
+    uint64_t events = 0;
+    uint64_t blocked_us = 0;
+    uint64_t processing_us = 0;
+    uint64_t last_events = 0;
+    uint64_t last_blocked_us = 0;
+    uint64_t last_processing_us = 0;
+};
+
+// 一个事件循环独占一个Poller和一个监听socket(SO_REUSEPORT)
+// 由它accept的连接此后的所有IO都只在该循环所在线程中进行
+class EventLoop {
+public:
+    using EventHandler = std::function<void(EventLoop&, const epoll_event&)>;
+    using FlushHandler = std::function<void(EventLoop&, int, uint32_t)>;
+
+    EventLoop(int index, int listenFd, int timeoutMs);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // 在新线程中运行事件循环
+    void start(EventHandler handler);
+    // 在调用线程中运行事件循环 直到stop()
+    void run(EventHandler handler);
+    void stop();
+    void join();
+
+    // 需在start()/run()之前设置 循环线程被唤醒后对每个待刷新的(fd, generation)调用一次
+    void setFlushHandler(FlushHandler handler) { flush_handler_ = std::move(handler); }
+    // 需在start()/run()之前设置 在循环线程进入循环前调用一次 用于绑核等线程级设置
+    void setThreadInit(std::function<void()> init) { thread_init_ = std::move(init); }
+    // 可在任意线程调用 把fd加入待刷新列表 一批中只有第一个加入者写eventfd唤醒循环
+    // generation随fd一起交给刷新回调 用于识别排队期间fd被复用
+    void queueFlush(int fd, uint32_t generation);
+
+    // 以下定时器接口只能在本循环线程中调用 最近的到期时间决定poll的超时
+    TimerWheel::TimerId runAfter(uint64_t delayMs, TimerWheel::Callback cb) { return timers_.schedule(delayMs, std::move(cb)); }
+    bool cancelTimer(TimerWheel::TimerId id) { return timers_.cancel(id); }
+    size_t timerCount() const { return timers_.size(); }
+
+    // 只能在本循环线程中调用 事件会在下一轮迭代中重新分发(本轮poll不阻塞)
+    // 用于边缘触发下读预算耗尽 但socket中仍有数据的连接
+    void deferEvent(const epoll_event& ev) { deferred_.push_back(ev); }
+
+    int getIndex() const { return index_; }
+    int getListenFd() const { return listen_fd_; }
+    Poller& getPoller() { return *poller_; }
+    // 可在任意线程调用 各字段分别原子读取 不保证彼此严格一致
+    LoopStats getStats() const;
+    bool isInLoopThread() const { return std::this_thread::get_id() == thread_id_.load(); }
+
+private:
+    int index_;
+    int listen_fd_;
+    int timeout_ms_;
+    std::unique_ptr<Poller> poller_;
+    TimerWheel timers_;
+    int wakeup_fd_;
+    FlushHandler flush_handler_;
+    std::function<void()> thread_init_;
+    std::mutex pending_mutex_;
+    std::vector<std::pair<int, uint32_t>> pending_flush_;
+    std::vector<std::pair<int, uint32_t>> flushing_;
+    std::vector<epoll_event> deferred_;
+    std::vector<epoll_event> deferred_dispatching_;
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_{};
+    std::atomic<bool> running_{true};
+
+    void wakeup();
+    void handleWakeup();
+
+    std::atomic<uint64_t> iterations_{0};
+    std::atomic<uint64_t> total_events_{0};
+    std::atomic<uint64_t> total_blocked_us_{0};
+    std::atomic<uint64_t> total_processing_us_{0};
+    std::atomic<uint64_t> last_events_{0};
+    std::atomic<uint64_t> last_blocked_us_{0};
+    std::atomic<uint64_t> last_processing_us_{0};
+};
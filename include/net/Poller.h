@@ -0,0 +1,26 @@
+#pragma once
+#include <sys/epoll.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// IO多路复用后端的统一接口 事件统一以epoll_event的形式返回
+// 各实现的addFd/modifyFd/removeFd都可以在任意线程调用
+// 事件的data.u64低32位是fd 高32位是注册时给的tag(连接的generation) 用eventFd/eventTag取出
+class Poller {
+public:
+    virtual ~Poller() = default;
+
+    virtual bool addFd(int fd, uint32_t events, uint32_t tag = 0) = 0;
+    virtual bool modifyFd(int fd, uint32_t events, uint32_t tag = 0) = 0;
+    virtual bool removeFd(int fd) = 0;
+    // 返回的事件视图指向Poller内部数组 在下一次poll()之前有效 稳态下不分配内存
+    virtual std::span<const epoll_event> poll(int timeoutMs = -1) = 0;
+    virtual const char* name() const = 0;
+
+    static uint64_t packData(int fd, uint32_t tag) {
+        return (static_cast<uint64_t>(tag) << 32) | static_cast<uint32_t>(fd);
+    }
+    static int eventFd(const epoll_event& ev) { return static_cast<int>(static_cast<uint32_t>(ev.data.u64)); }
+    static uint32_t eventTag(const epoll_event& ev) { return static_cast<uint32_t>(ev.data.u64 >> 32); }
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/socket.h>
 
 inline bool setNonBlocking(int fd) {
     int flags = fcntl(fd, F_GETFL, 0);
@@ -11,4 +12,10 @@ inline bool setNonBlocking(int fd) {
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+// 多个监听socket绑定同一端口 由内核按连接哈希分发到各个事件循环
+inline bool setReusePort(int fd) {
+    int opt = 1;
+    return setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == 0;
+}
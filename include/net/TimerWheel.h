@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 分层时间轮 第0层256个槽 其余3层各64个槽 共覆盖2^26个tick(tick为10ms时约7.7天)
+// 定时器节点放在复用的节点池中 槽内为双向链表 插入/取消都是O(1)
+// 非线程安全 只在所属事件循环线程中使用
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    explicit TimerWheel(uint32_t tickMs = 10);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // delayMs后执行cb 精度为一个tick 返回的id可用于cancel
+    TimerId schedule(uint64_t delayMs, Callback cb);
+    // 定时器已执行或已取消时返回false
+    bool cancel(TimerId id);
+
+    // 推进到nowMs 执行所有到期的回调 返回执行的数量
+    size_t advance(uint64_t nowMs);
+    // 距下一个可能有定时器到期的tick还有多少毫秒 不超过maxMs(为负表示不限) 没有定时器时返回maxMs
+    int nextTimeoutMs(uint64_t nowMs, int maxMs) const;
+
+    size_t size() const { return count_; }
+    uint32_t tickMs() const { return tick_ms_; }
+
+    // 单调时钟 毫秒
+    static uint64_t nowMs();
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int ROOT_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr uint32_t ROOT_SIZE = 1u << ROOT_BITS;
+    static constexpr uint32_t LEVEL_SIZE = 1u << LEVEL_BITS;
+    static constexpr uint64_t MAX_TICKS = 1ull << (ROOT_BITS + (LEVELS - 1) * LEVEL_BITS);
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr uint8_t DETACHED = 0xff;
+
+    struct Node {
+        Callback callback;
+        uint64_t expires = 0;   // 到期的tick
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t generation = 1;
+        uint16_t slot = 0;
+        uint8_t level = 0;
+        bool active = false;
+    };
+
+    struct Level {
+        std::vector<uint32_t> heads;
+        std::array<uint64_t, ROOT_SIZE / 64> occupied{};  // 非空槽位图
+    };
+
+    uint32_t allocNode();
+    void freeNode(uint32_t index);
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void cascade(int level, uint32_t slot);
+    TimerId makeId(uint32_t index) const {
+        return (static_cast<uint64_t>(nodes_[index].generation) << 32) | (index + 1);
+    }
+    uint64_t tickOf(uint64_t ms) const { return (ms - start_ms_) / tick_ms_; }
+
+    uint32_t tick_ms_;
+    uint64_t start_ms_;
+    uint64_t current_ = 0;  // 下一个要处理的tick
+    size_t count_ = 0;
+
+    std::array<Level, LEVELS> levels_;
+    std::vector<Node> nodes_;
+    uint32_t free_head_ = NIL;
+    std::vector<TimerId> expired_;  // advance时复用
+};
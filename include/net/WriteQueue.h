@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+// 已编码好的完整帧(头部+消息体) 不可变 可被多个连接的发送队列共享
+using SharedFrame = std::shared_ptr<const std::string>;
+
+struct DropResult {
+    size_t frames = 0;
+    size_t bytes = 0;
+};
+
+struct FlushResult {
+    ssize_t bytes_sent;
+    int syscalls;
+    bool would_block;
+    bool error;
+};
+
+// 每个连接的待发送帧队列 用sendmsg一次提交多个帧(最多IOV_MAX个)
+// 记录队首帧的发送偏移 支持部分写
+// 非线程安全 由Connection的锁保护
+class WriteQueue {
+public:
+    void push(SharedFrame frame);
+    void clear();
+
+    bool empty() const { return frames_.empty(); }
+    size_t size() const { return frames_.size(); }
+    size_t bytes() const { return bytes_; }
+
+    // 持续发送直到队列清空或遇到EAGAIN
+    FlushResult flush(int fd);
+
+    // 从队首开始丢弃满足条件的帧 直到队列字节数不超过targetBytes(为0则丢弃全部满足条件的帧)
+    // 已部分发送的队首帧不会被丢弃
+    DropResult dropOldest(const std::function<bool(uint16_t)>& droppable, size_t targetBytes);
+
+    // 从帧头读取消息类型
+    static uint16_t frameType(const std::string& frame);
+
+private:
+    void consume(size_t len);
+
+    std::deque<SharedFrame> frames_;
+    size_t head_offset_ = 0;  // 队首帧已发送的字节数
+    size_t bytes_ = 0;        // 队列中尚未发送的总字节数
+};
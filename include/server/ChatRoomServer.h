@@ -3,16 +3,38 @@
 #include <unordered_map>
 #include <mutex>
 #include <unordered_set>
-#include "net/EpollPoller.h"
+#include <string_view>
+#include "net/EventLoop.h"
 #include "net/Connection.h"
-#include "utils/ThreadPool.h"
+#include "net/ConnectionTable.h"
+#include "net/Backpressure.h"
+#include "utils/Executor.h"
+#include "utils/ExecutorLane.h"
+#include "utils/CoTask.h"
+#include "utils/Histogram.h"
+#include "utils/TokenSigner.h"
+#include "utils/RevocationList.h"
+#include "utils/SnowflakeId.h"
+#include "database/AsyncDb.h"
 #include "service/ServiceManager.h"
+#include "service/MessageBatcher.h"
+#include "utils/AsyncResult.h"
 #include "server/Protocol.h"
+#include "server/RoomHistoryCache.h"
+#include "server/RoomSequencer.h"
 #include <jsoncpp/json/json.h>
 #include <thread>
 #include <atomic>
 
 constexpr int ROOM_ID_NONE = -1;
+constexpr int MESSAGE_HISTORY_DEFAULT_LIMIT = 50;
+constexpr int MESSAGE_HISTORY_MAX_LIMIT = 200;
+
+// 按消息类型统计请求延迟 表在启动时建好之后只读 记录时不加锁
+struct RequestMetrics {
+    Histogram wait_us;  // 从读到请求到开始处理 包括Strand和执行器排队
+    Histogram run_us;   // 处理耗时 包括协程挂起等待数据库的时间
+};
 
 struct RoomInfo {
     std::string name;
@@ -39,21 +61,47 @@ public:
     void stop();
 
 private:
+    int reactor_count_;
     int epoll_timeout_ms_;
     int max_read_buffer_size_;
     int max_write_buffer_size_;
     int64_t token_expire_minutes_;
-    int cleanup_interval_minutes_;
+    uint64_t token_expiry_tick_ms_;
+    size_t token_expiry_batch_;
+    uint64_t heartbeat_interval_ms_;
+    uint64_t heartbeat_timeout_ms_;
+    bool edge_triggered_;
+    int read_budget_bytes_;
+    uint32_t client_events_;
+    // 关闭中的连接最多等这么久把队列写完 之后直接关闭
+    uint64_t close_drain_timeout_ms_;
+    // 绑核CPU列表 空表示交给内核调度
+    std::vector<int> reactor_cpus_;
+    std::vector<int> worker_cpus_;
 
 private:
-    int listen_fd_;
     uint16_t port_;
-    EpollPoller poller_;
-    std::unique_ptr<ThreadPool> thread_pool_;
-    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
-    std::mutex connections_mutex_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    // 执行通道: 纯内存的控制类请求 / 访问数据库的请求 / 密码哈希等CPU密集请求
+    std::unique_ptr<ExecutorLane> control_lane_;
+    std::unique_ptr<ExecutorLane> db_lane_;
+    std::unique_ptr<ExecutorLane> cpu_lane_;
+    std::unordered_map<uint16_t, ExecutorLane*> message_lanes_;
+    // 协程处理函数的数据库调用在这里执行 挂起期间不占用通道的工作线程
+    std::unique_ptr<AsyncDb> async_db_;
+    std::unordered_map<uint16_t, std::unique_ptr<RequestMetrics>> request_metrics_;
+    std::unique_ptr<BackpressureController> backpressure_;
+    ConnectionTable connections_;
     
     std::shared_ptr<ServiceManager> service_manager_;
+    // 聊天消息先推送给房间 再由批量写入线程异步落库 消息id和房间序号都在推送前于内存中分配
+    std::unique_ptr<MessageBatcher> message_batcher_;
+    std::unique_ptr<SnowflakeId> message_ids_;
+    RoomSequencer room_sequences_;
+    // 每个房间最近的消息 历史查询的窗口落在其中时不查数据库
+    std::unique_ptr<RoomHistoryCache> room_history_;
+    std::atomic<uint64_t> history_cache_hits_{0};
+    std::atomic<uint64_t> history_cache_misses_{0};
     
     std::unordered_map<int, RoomInfo> active_rooms_;
     std::mutex active_rooms_mutex_;
@@ -70,60 +118,89 @@ private:
     std::unordered_map<int, int> userId_to_roomId_;
     std::mutex userId_to_roomId_mutex_;
     
-    std::unordered_map<int, std::pair<std::string, int64_t>> userId_to_token_; 
-    std::mutex userId_to_token_mutex_;
-    
-    std::atomic<int> token_counter_{0};
+    // 令牌自带用户/角色/过期时间并由HMAC签名 校验不查共享表 只有注销的令牌记在吊销集合里
+    std::unique_ptr<TokenSigner> token_signer_;
+    RevocationList revoked_tokens_;
+    // 发消息时显示名的会话缓存命中/未命中次数
+    std::atomic<uint64_t> profile_cache_hits_{0};
+    std::atomic<uint64_t> profile_cache_misses_{0};
     
     std::atomic<bool> running_{false};
     
-    std::thread cleanup_thread_;
-    std::atomic<bool> cleanup_running_{true};
     
     void setupServer();
+    void setupExecutors();
+    ExecutorLane& laneFor(uint16_t messageType);
+    int createListenSocket(bool reusePort);
     void setupServices();
+    void setupMessagePersistence();
     void loadRoomsFromDatabase();
     
 private:
-    void handleEvent(const epoll_event& ev);
-    void handleNewConnection();
-    void handleReadEvent(int fd);
-    void handleWriteEvent(int fd);
-    void handleConnectionError(int fd);
-    void cleanupConnection(int fd);
+    void handleEvent(EventLoop& loop, const epoll_event& ev);
+    void handleNewConnection(EventLoop& loop);
+    // 连接必须仍是这一代且归属于这个循环 否则返回空 调用方不得对fd做任何I/O
+    std::shared_ptr<Connection> loopConnection(EventLoop& loop, int fd, uint32_t generation) const;
+    void handleReadEvent(EventLoop& loop, int fd, uint32_t generation);
+    void handleWriteEvent(EventLoop& loop, int fd, uint32_t generation);
+    void handleFlush(EventLoop& loop, int fd, uint32_t generation);
+    // 关闭中的连接写完(drained)就关闭 否则只等EPOLLOUT 超时后不再等待
+    void closeWhenDrained(EventLoop& loop, Connection& connection, int fd, uint32_t generation, bool drained);
+    void handleConnectionError(int fd, uint32_t generation);
+    // 心跳: 空闲超过间隔发PING 再等超时时间仍无任何数据则断开
+    void scheduleHeartbeat(EventLoop& loop, std::weak_ptr<Connection> weak, uint64_t delayMs);
+    void checkHeartbeat(EventLoop& loop, const std::weak_ptr<Connection>& weak);
+    // 只清理仍是这一代的连接 fd的关闭只在这里进行
+    void cleanupConnection(int fd, uint32_t generation);
+    // 解除fd上的登录会话: 吊销令牌 清理用户映射 离开房间 可重复调用
+    void detachSession(int fd, Connection& connection);
+
+private:
+    // 协程 按值接收消息 挂起期间消息内容保存在协程帧里
+    CoTask<void> handleRequest(int fd, uint32_t generation, NetworkMessage message);
+    void handleRegister(int fd, std::string_view data);
+    void handleChangePassword(int fd, std::string_view data);
+    void handleChangeDisplayName(int fd, std::string_view data);
+    CoTask<void> handleLogin(int fd, uint32_t generation, std::string_view data);
+    void handleLogout(int fd, uint32_t generation, std::string_view data);
+    void handleFetchActiveRooms(int fd, std::string_view data);
+    void handleFetchInactiveRooms(int fd, std::string_view data);
+    void handleCreateRoom(int fd, std::string_view data);
+    void handleDeleteRoom(int fd, std::string_view data);
+    void handleSetRoomName(int fd, std::string_view data);
+    void handleSetRoomDescription(int fd, std::string_view data);
+    void handleSetRoomMaxUsers(int fd, std::string_view data);
+    void handleSetRoomStatus(int fd, std::string_view data);
+    CoTask<void> handleSendMessage(int fd, std::string_view data);
+    CoTask<void> handleGetMessageHistory(int fd, std::string_view data);
+    void handleJoinRoom(int fd, std::string_view data);
+    void handleLeaveRoom(int fd, std::string_view data);
+    void handleGetUserInfo(int fd, std::string_view data);
+    void handleFetchServerStats(int fd, std::string_view data);
 
 private:
-    void handleRequest(int fd, const NetworkMessage& message);
-    void handleRegister(int fd, const std::string& data);
-    void handleChangePassword(int fd, const std::string& data);
-    void handleChangeDisplayName(int fd, const std::string& data);
-    void handleLogin(int fd, const std::string& data);
-    void handleLogout(int fd, const std::string& data);
-    void handleFetchActiveRooms(int fd, const std::string& data);
-    void handleFetchInactiveRooms(int fd, const std::string& data);
-    void handleCreateRoom(int fd, const std::string& data);
-    void handleDeleteRoom(int fd, const std::string& data);
-    void handleSetRoomName(int fd, const std::string& data);
-    void handleSetRoomDescription(int fd, const std::string& data);
-    void handleSetRoomMaxUsers(int fd, const std::string& data);
-    void handleSetRoomStatus(int fd, const std::string& data);
-    void handleSendMessage(int fd, const std::string& data);
-    void handleGetMessageHistory(int fd, const std::string& data);
-    void handleJoinRoom(int fd, const std::string& data);
-    void handleLeaveRoom(int fd, const std::string& data);
-    void handleGetUserInfo(int fd, const std::string& data);
+    // 事件循环/执行通道/线程池/数据库I/O/写背压/按消息类型的请求延迟
+    Json::Value collectStats() const;
 
 private:
     void notifyRoomUsers(int roomId, uint16_t messageType, const Json::Value& notification);
+    // 房间内在线用户的连接
+    std::vector<std::shared_ptr<Connection>> roomConnections(int roomId);
 
 private:
-    bool parseJson(const std::string& data, Json::Value& root);
+    bool parseJson(std::string_view data, Json::Value& root);
     bool validateRequiredFields(const Json::Value& root, const std::vector<std::string>& requiredFields);
     void sendResponse(int fd, uint16_t responseType, const Json::Value& response);
-    void sendErrorResponse(int fd, uint16_t responseType, const std::string& message);
+    void sendFrame(int fd, const SharedFrame& frame);
+    void sendErrorResponse(int fd, uint16_t responseType, const std::string& message,
+                           ErrorCode code = ErrorCode::BAD_REQUEST);
     
 private:
-    std::string generateToken(int userId, const std::string& role);
+    // 签发令牌并绑定到连接 连接上之前的令牌被吊销 签发失败时返回空串且不改动会话
+    std::string generateToken(int fd, int userId, bool isAdmin);
+    // 2: 无效 1: 管理员 0: 普通用户
     int validateToken(int fd, std::string& token);
-    void cleanupExpiredTokens();
+    void revokeToken(uint64_t tokenId);
+    // 由0号事件循环的定时器周期调用 每次最多清除token_expiry_batch_个过期的吊销条目
+    void scheduleTokenExpiry(EventLoop& loop);
 };
\ No newline at end of file
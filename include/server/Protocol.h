@@ -19,6 +19,7 @@ constexpr uint16_t MSG_GET_MESSAGE_HISTORY = 15;
 constexpr uint16_t MSG_JOIN_ROOM = 16;
 constexpr uint16_t MSG_LEAVE_ROOM = 17;
 constexpr uint16_t MSG_GET_USER_INFO = 18;
+constexpr uint16_t MSG_FETCH_SERVER_STATS = 19;
 
 
 constexpr uint16_t MSG_REGISTER_RESPONSE = 1001;
@@ -39,6 +40,7 @@ constexpr uint16_t MSG_GET_MESSAGE_HISTORY_RESPONSE = 1015;
 constexpr uint16_t MSG_JOIN_ROOM_RESPONSE = 1016;
 constexpr uint16_t MSG_LEAVE_ROOM_RESPONSE = 1017;
 constexpr uint16_t MSG_GET_USER_INFO_RESPONSE = 1018;
+constexpr uint16_t MSG_FETCH_SERVER_STATS_RESPONSE = 1019;
 
 
 constexpr uint16_t MSG_CHAT_MESSAGE_PUSH = 2001;
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "models/Message.h"
+#include "utils/AsyncResult.h"
+
+struct RoomHistoryStats {
+    uint64_t rooms;
+    uint64_t messages;
+    uint64_t unpersisted;     // 已追加但还没确认落库的消息
+    uint64_t warmups;         // 从数据库加载的次数
+    uint64_t warmup_waits;    // 等待别的请求加载完成的次数
+};
+
+// 每个房间最近capacity条消息的内存副本 按message_id升序 满了丢最旧的
+// 发消息时追加 不论房间是否已加载 首次查询历史时再从数据库加载(warm)并与已追加的消息合并
+// 还没落库的消息不会被丢弃(副本可以暂时超过capacity) 它们总在末尾: id在房间锁内递增分配 批量写入按提交顺序落库
+// 同一房间同时只有一个请求去加载 其余请求co_await等待结果
+class RoomHistoryCache {
+public:
+    // 加载凭证 load为true时由调用方查数据库并调用completeWarm 否则co_await ready
+    struct WarmTicket {
+        bool load;
+        AsyncResult<bool> ready;
+    };
+
+    explicit RoomHistoryCache(size_t capacity);
+
+    size_t capacity() const { return capacity_; }
+
+    // 提交写入之前调用 追加的消息记为未落库 已存在(被拒绝)时返回false 此时不要再调用markPersisted
+    bool append(const Message& message);
+    // 不论写入成功与否都要调用 失败(或没能提交)的消息从副本中移除 不会落库也就不能留着
+    // 同一房间的回调须按message_id顺序到来(写入队列先进先出) 找不到这条消息(房间已删除重建)时什么都不做
+    void markPersisted(int roomId, int64_t messageId, bool ok);
+    // message_id小于beforeMessageId且未落库的最新limit条 按id倒序 数据库分页需要先拼上它们
+    std::vector<Message> unpersisted(int roomId, int64_t beforeMessageId, size_t limit);
+    // message_id小于beforeMessageId的最新limit条 按id倒序(与DAO一致)
+    // 房间未加载或窗口超出内存副本时返回nullopt 由调用方查数据库
+    std::optional<std::vector<Message>> recent(int roomId, int64_t beforeMessageId, size_t limit);
+    bool isWarm(int roomId);
+    WarmTicket acquireWarm(int roomId);
+    // rows为数据库中最新的requested条消息 加载失败时传nullptr 等待方会收到false
+    void completeWarm(int roomId, const std::vector<Message>* rows, size_t requested);
+    void dropRoom(int roomId);
+    RoomHistoryStats getStats() const;
+
+private:
+    struct Ring {
+        std::mutex mutex;
+        std::deque<Message> messages;
+        bool warm = false;
+        bool loading = false;
+        bool evicted = false;   // 加载前是否已因容量丢过消息
+        bool complete = false;  // 内存副本包含该房间的全部消息
+        // 末尾未落库的条数
+        int64_t unpersisted = 0;
+        std::vector<AsyncResult<bool>> waiters;
+    };
+
+    std::shared_ptr<Ring> ring(int roomId, bool create);
+    // 按message_id插入 新消息总在末尾 加载时合并的数据库行要往前找位置 已存在时返回false
+    bool insertLocked(Ring& ring, const Message& message);
+    // 超过容量时从头丢弃 但不丢未落库的
+    void trimLocked(Ring& ring);
+
+    size_t capacity_;
+    mutable std::mutex rooms_mutex_;
+    std::unordered_map<int, std::shared_ptr<Ring>> rooms_;
+    std::atomic<uint64_t> warmups_{0};
+    std::atomic<uint64_t> warmup_waits_{0};
+};
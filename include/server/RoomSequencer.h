@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// 每个房间的消息序号 从1开始连续递增
+// 分配序号和推送入队在同一把房间锁内完成 同一房间的推送按序号顺序进入各连接的发送队列 实际发送在锁外
+// 客户端收到的序号不连续就说明中间有消息丢了(如背压丢帧) 按序号补拉即可
+class RoomSequencer {
+public:
+    // 启动时用库中每个房间已用到的最大序号初始化
+    void seed(int roomId, int64_t lastSeq);
+
+    // 在房间锁内以下一个序号调用publish(seq) publish返回true才算用掉这个序号
+    // 返回用掉的序号 publish失败时返回0
+    template<typename Publish>
+    int64_t next(int roomId, Publish&& publish) {
+        auto r = room(roomId);
+        std::lock_guard<std::mutex> lock(r->mutex);
+        int64_t seq = r->last + 1;
+        if (!publish(seq)) return 0;
+        r->last = seq;
+        return seq;
+    }
+
+    void dropRoom(int roomId);
+
+private:
+    struct Room {
+        std::mutex mutex;
+        int64_t last = 0;
+    };
+
+    std::shared_ptr<Room> room(int roomId);
+
+    std::mutex mutex_;
+    std::unordered_map<int, std::shared_ptr<Room>> rooms_;
+};
@@ -14,7 +14,8 @@ enum class ErrorCode {
     FORBIDDEN = 403,
     NOT_FOUND = 404,
     CONFLICT = 409,
-    INTERNAL_ERROR = 500
+    INTERNAL_ERROR = 500,
+    SERVICE_UNAVAILABLE = 503
 };
 
 template<typename T>
@@ -53,6 +54,9 @@ public:
     
     ServiceResult<User> getUserInfo(int userId);
     ServiceResult<User> login(const std::string& email, const std::string& password);
+    // 登录拆成两步: 查询(阻塞在数据库上)和密码校验(纯计算) 调用方可以把它们放到不同的线程
+    ServiceResult<UserCredentials> fetchLoginCredentials(const std::string& email);
+    static ServiceResult<User> verifyLogin(const UserCredentials& credentials, const std::string& password);
     ServiceResult<std::vector<Room>> getActiveRooms();
     ServiceResult<Room> getRoomInfo(int roomId);
     
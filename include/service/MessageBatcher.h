@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "models/Message.h"
+#include "utils/Histogram.h"
+
+struct MessageBatcherConfig {
+    size_t batch_size = 256;        // 每条INSERT最多写入的行数
+    int flush_interval_ms = 20;     // 不满一批时最多等待多久就写
+    size_t max_pending = 100000;    // 排队上限 超过后submit()拒绝
+    int max_retries = 5;            // 一批写入失败后的重试次数
+    int retry_backoff_ms = 50;      // 首次重试的等待时间 之后每次翻倍
+};
+
+struct MessageBatcherStats {
+    uint64_t pending;
+    uint64_t persisted;   // 已写入的消息数
+    uint64_t batches;     // 成功写入的批次数
+    uint64_t retries;
+    uint64_t failed;      // 重试用尽后丢弃的消息数
+    uint64_t rejected;    // 队列满时拒绝的消息数
+    HistogramSnapshot batch_size;
+    HistogramSnapshot flush_us;
+};
+
+// 消息的异步批量写入(write-behind)
+// 请求线程只把消息放进队列就返回 一个后台线程攒够batch_size条或等到flush_interval_ms后用一条多行INSERT写入
+// 写入失败按指数退避重试 重试用尽后丢弃这一批并记录日志 不会阻塞后面的消息太久
+// 每条消息可带一个回调 写入成功或最终失败时在后台线程调用
+class MessageBatcher {
+public:
+    // 写入一批消息 成功返回true 会在后台线程调用
+    using FlushFunc = std::function<bool(const std::vector<Message>&)>;
+    using PersistedCallback = std::function<void(bool)>;
+
+    MessageBatcher(FlushFunc flush, MessageBatcherConfig config = {});
+    ~MessageBatcher();
+
+    MessageBatcher(const MessageBatcher&) = delete;
+    MessageBatcher& operator=(const MessageBatcher&) = delete;
+
+    // 队列已满或已停止时返回false 此时回调不会被调用
+    bool submit(Message message, PersistedCallback onPersisted = nullptr);
+    // 写完队列里剩下的消息后停止后台线程
+    void stop();
+    MessageBatcherStats getStats() const;
+
+private:
+    struct Pending {
+        Message message;
+        PersistedCallback on_persisted;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    void run();
+    void flushBatch(std::vector<Pending>& batch);
+
+    FlushFunc flush_;
+    MessageBatcherConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+    bool stopping_ = false;
+
+    std::atomic<uint64_t> pending_{0};  // 已提交但还没有结果的消息 包括正在写入的一批
+    std::atomic<uint64_t> persisted_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    Histogram batch_size_;
+    Histogram flush_us_;
+
+    std::thread thread_;
+};
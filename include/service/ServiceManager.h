@@ -17,10 +17,17 @@ public:
     ServiceResult<User> registerUser(const std::string& email, const std::string& password, const std::string& name);
     ServiceResult<void> changePassword(const std::string& email, const std::string& oldPassword, const std::string& newPassword);
     ServiceResult<void> changeDisplayName(int userId, const std::string& newName);
-    ServiceResult<void> sendMessage(int userId, int roomId, const std::string& content, const std::string& displayName, const std::string& sendTime);
     ServiceResult<std::vector<Message>> getMessageHistory(int roomId, int limit = 50);
+    ServiceResult<void> streamMessageHistory(int roomId, int64_t beforeMessageId, int limit, const std::function<bool(const Message&)>& onMessage);
+    ServiceResult<void> saveMessages(const std::vector<Message>& messages);
+    ServiceResult<int64_t> getMaxMessageId();
+    ServiceResult<std::vector<std::pair<int, int64_t>>> getRoomSequences();
+    // 成功时data为false表示已有别的实例在写消息
+    ServiceResult<bool> acquireMessageWriterLock();
     
     ServiceResult<User> login(const std::string& email, const std::string& password);
+    ServiceResult<UserCredentials> fetchLoginCredentials(const std::string& email);
+    ServiceResult<User> verifyLogin(const UserCredentials& credentials, const std::string& password);
     ServiceResult<std::vector<Room>> getActiveRooms();  
     ServiceResult<Room> getRoomInfo(int roomId);
 
@@ -0,0 +1,54 @@
+#pragma once
+#include <coroutine>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include "utils/Executor.h"
+
+// 一次性的异步结果 生产方在任意线程set() 等待方co_await拿到值
+// 等待方挂起前所在的执行器会被记住 set()时协程回到该执行器继续
+// set()先于co_await时不会挂起 set()只应调用一次 多余的调用被忽略
+template<typename T>
+class AsyncResult {
+public:
+    AsyncResult() : state_(std::make_shared<State>()) {}
+
+    void set(T value) const {
+        std::coroutine_handle<> waiter;
+        Executor* resumeOn = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (state_->value) return;
+            state_->value.emplace(std::move(value));
+            waiter = std::exchange(state_->waiter, {});
+            resumeOn = state_->resume_on;
+        }
+        if (waiter) Executor::resume(resumeOn, waiter);
+    }
+
+    bool await_ready() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->value.has_value();
+    }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->value) return false;
+        state_->waiter = h;
+        state_->resume_on = Executor::current();
+        return true;
+    }
+
+    T await_resume() { return std::move(*state_->value); }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::optional<T> value;
+        std::coroutine_handle<> waiter;
+        Executor* resume_on = nullptr;
+    };
+
+    std::shared_ptr<State> state_;
+};
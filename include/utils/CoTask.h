@@ -0,0 +1,137 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <utility>
+
+// 协程任务 创建后不立即执行(惰性)
+// 在另一个协程里 co_await 它: 执行到结束后回到等待方继续
+// 作为顶层任务 start(done): 开始执行 结束时调用done 协程帧自行销毁
+template<typename T = void>
+class CoTask;
+
+namespace detail {
+
+template<typename T>
+struct CoTaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::function<void()> on_done;  // 顶层任务的结束回调
+    bool detached = false;          // 已通过start()脱离CoTask对象 结束时自行销毁
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            auto& promise = h.promise();
+            if (promise.continuation) return promise.continuation;
+            if (promise.detached) {
+                if (promise.exception) {
+                    try {
+                        std::rethrow_exception(promise.exception);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Unhandled exception in coroutine: " << e.what() << std::endl;
+                    } catch (...) {
+                        std::cerr << "Unhandled exception in coroutine" << std::endl;
+                    }
+                }
+                auto done = std::move(promise.on_done);
+                h.destroy();
+                if (done) done();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+template<typename T>
+struct CoTaskPromise : CoTaskPromiseBase<T> {
+    std::optional<T> value;
+
+    CoTask<T> get_return_object() noexcept;
+    template<typename U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+    T result() {
+        if (this->exception) std::rethrow_exception(this->exception);
+        return std::move(*value);
+    }
+};
+
+template<>
+struct CoTaskPromise<void> : CoTaskPromiseBase<void> {
+    CoTask<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+
+    void result() {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+}
+
+template<typename T>
+class CoTask {
+public:
+    using promise_type = detail::CoTaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit CoTask(Handle h) noexcept : handle_(h) {}
+    CoTask(CoTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    ~CoTask() {
+        if (handle_) handle_.destroy();
+    }
+
+    // 作为顶层任务开始执行 之后CoTask对象不再持有协程 协程结束时调用done
+    void start(std::function<void()> done = nullptr) {
+        Handle h = std::exchange(handle_, {});
+        h.promise().on_done = std::move(done);
+        h.promise().detached = true;
+        h.resume();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().result(); }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+
+template<typename T>
+CoTask<T> CoTaskPromise<T>::get_return_object() noexcept {
+    return CoTask<T>(std::coroutine_handle<CoTaskPromise<T>>::from_promise(*this));
+}
+
+inline CoTask<void> CoTaskPromise<void>::get_return_object() noexcept {
+    return CoTask<void>(std::coroutine_handle<CoTaskPromise<void>>::from_promise(*this));
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+
+class CpuAffinity {
+public:
+    // 解析CPU列表 格式同taskset/cpuset: "0-3,8,10-11" 格式错误返回nullopt
+    static std::optional<std::vector<int>> parseCpuList(const std::string& spec);
+
+    // 把当前线程绑定到给定CPU集合 失败返回false
+    static bool pinCurrentThread(const std::vector<int>& cpus);
+
+    // CPU所属的NUMA节点 从/sys读取 不依赖libnuma 无法确定时返回-1
+    static int nodeOfCpu(int cpu);
+
+    // 当前线程实际的放置情况 如 "cpus 0-3 (node 0), running on cpu 2"
+    static std::string describeCurrentThread();
+
+    // 把CPU列表格式化成区间形式 如 "0-3,8"
+    static std::string formatCpuList(const std::vector<int>& cpus);
+};
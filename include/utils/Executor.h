@@ -0,0 +1,64 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include "utils/Task.h"
+#include "utils/PoolMetrics.h"
+
+// 任务执行器的统一接口 ThreadPool和WorkStealingPool都实现它 Strand建立在它之上
+class Executor {
+public:
+    // 每个工作线程启动时以线程序号调用一次 用于绑核等线程级设置
+    using ThreadInit = std::function<void(size_t)>;
+
+    virtual ~Executor() = default;
+
+    virtual void addTask(Task task) = 0;
+    virtual void stop() = 0;
+    virtual size_t threadCount() const = 0;
+    virtual const char* name() const = 0;
+    virtual ExecutorStats getStats() const = 0;
+
+    // 当前线程正在替哪个执行器运行任务 协程挂起后据此回到原执行器继续 没有则为nullptr
+    static Executor* current() { return t_current; }
+
+    // 在executor上恢复挂起的协程 executor为空时在当前线程直接恢复
+    static void resume(Executor* executor, std::coroutine_handle<> h) {
+        if (!executor) {
+            h.resume();
+            return;
+        }
+        executor->addTask([executor, h]() {
+            Scope scope(executor);
+            h.resume();
+        });
+    }
+
+    // co_await Executor::switchTo(executor)之后协程一定在executor上运行 已经在它上面时不挂起
+    class SwitchTo {
+    public:
+        explicit SwitchTo(Executor& target) : target_(target) {}
+        bool await_ready() const noexcept { return current() == &target_; }
+        void await_suspend(std::coroutine_handle<> h) { resume(&target_, h); }
+        void await_resume() const noexcept {}
+
+    private:
+        Executor& target_;
+    };
+    static SwitchTo switchTo(Executor& executor) { return SwitchTo(executor); }
+
+    // 在作用域内把当前线程标记为某个执行器的工作线程
+    class Scope {
+    public:
+        explicit Scope(Executor* executor) : previous_(t_current) { t_current = executor; }
+        ~Scope() { t_current = previous_; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Executor* previous_;
+    };
+
+private:
+    static inline thread_local Executor* t_current = nullptr;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "utils/Executor.h"
+
+struct LaneStats {
+    std::string name;
+    size_t threads;
+    size_t queue_limit;
+    uint64_t pending;       // 已接收尚未执行完的任务数
+    uint64_t peak_pending;
+    uint64_t submitted;
+    uint64_t rejected;
+    uint64_t completed;
+    uint64_t wait_us;       // 累计排队时间
+    uint64_t run_us;        // 累计执行时间
+    ExecutorStats pool;     // 通道执行器自身的统计
+};
+
+// 一条执行通道: 独立的执行器 独立的排队上限 独立的统计
+// 请求按消息类型路由到不同通道 数据库变慢时只会占满数据库通道
+class ExecutorLane {
+public:
+    ExecutorLane(std::string name, std::unique_ptr<Executor> executor, size_t queueLimit);
+
+    ExecutorLane(const ExecutorLane&) = delete;
+    ExecutorLane& operator=(const ExecutorLane&) = delete;
+
+    const std::string& name() const { return name_; }
+    Executor& executor() { return *executor_; }
+
+    // 排队数未到上限时占用一个名额并返回true 否则计入rejected
+    bool tryAcquire();
+    // 任务开始/结束执行时调用 onFinish释放tryAcquire占用的名额
+    void onStart(uint64_t waitUs);
+    void onFinish(uint64_t runUs);
+
+    LaneStats getStats() const;
+    void stop() { executor_->stop(); }
+
+private:
+    std::string name_;
+    std::unique_ptr<Executor> executor_;
+    size_t queue_limit_;
+
+    std::atomic<uint64_t> pending_{0};
+    std::atomic<uint64_t> peak_pending_{0};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> wait_us_{0};
+    std::atomic<uint64_t> run_us_{0};
+};
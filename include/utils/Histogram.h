@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+};
+
+// HDR风格的对数线性直方图 每个2的幂区间再均分SUB_BUCKETS份 相对误差不超过1/SUB_BUCKETS
+// 记录只做原子加 不加锁 可以在任意线程并发调用 快照不是严格一致的但足够用于观测
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BITS;
+    // 小于2*SUB_BUCKETS的值精确记录 之后每个2的幂区间SUB_BUCKETS个桶 覆盖到2^63
+    static constexpr size_t BUCKET_COUNT = 2 * SUB_BUCKETS + (63 - SUB_BITS) * SUB_BUCKETS;
+
+    void record(uint64_t value);
+    HistogramSnapshot snapshot() const;
+    void reset();
+
+private:
+    static size_t bucketIndex(uint64_t value);
+    // 桶内最大值 用于报告分位数 报告值不会低于真实值
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
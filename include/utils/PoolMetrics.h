@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils/Histogram.h"
+
+struct WorkerStats {
+    uint64_t tasks;
+    uint64_t busy_us;
+    uint64_t idle_us;
+};
+
+struct ExecutorStats {
+    std::string type;
+    size_t threads = 0;
+    std::vector<WorkerStats> workers;
+    HistogramSnapshot queue_wait_us;  // 入队到开始执行
+    HistogramSnapshot run_us;         // 单个任务执行时间
+    HistogramSnapshot queue_depth;    // 每次入队后的队列长度
+};
+
+// 线程池的观测数据 每个工作线程只写自己的计数器 直方图无锁
+class PoolMetrics {
+public:
+    explicit PoolMetrics(size_t workerCount);
+
+    static uint64_t nowUs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void onEnqueue(uint64_t depth) { queue_depth_.record(depth); }
+    void onDequeue(uint64_t waitUs) { queue_wait_.record(waitUs); }
+    // 工作线程空闲了idleUs后执行了一个耗时runUs的任务
+    void onTask(size_t worker, uint64_t idleUs, uint64_t runUs);
+
+    ExecutorStats snapshot(const char* type) const;
+
+private:
+    struct alignas(64) WorkerCounters {
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> busy_us{0};
+        std::atomic<uint64_t> idle_us{0};
+    };
+
+    std::unique_ptr<WorkerCounters[]> workers_;
+    size_t worker_count_;
+    Histogram queue_wait_;
+    Histogram run_;
+    Histogram queue_depth_;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "utils/Histogram.h"
+
+struct RevocationStats {
+    uint64_t size;
+    uint64_t revoked;
+    uint64_t expired;
+    HistogramSnapshot expire_lock_hold_us;  // 过期清理每次持锁的时间
+};
+
+// 已吊销令牌的集合 按token_id分片 每片一把锁 没有全局锁
+// 条目保留到令牌本身过期为止 每片按过期时间分桶(BUCKET_MS一个桶)
+// 过期清理由定时器反复调用expire() 每次只处理到期的桶 每次持锁最多清除EXPIRE_BATCH个条目
+class RevocationList {
+public:
+    static constexpr int64_t BUCKET_MS = 1000;
+    static constexpr size_t EXPIRE_BATCH = 256;
+
+    void revoke(uint64_t tokenId, int64_t expiresMs);
+    bool contains(uint64_t tokenId) const;
+    // 清除已过期的条目 最多清除maxEntries个 返回清除数量 剩下的留给下一次调用
+    size_t expire(int64_t nowMs, size_t maxEntries);
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    RevocationStats getStats() const;
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, int64_t> entries;
+        // 桶序号(过期时间/BUCKET_MS) -> 该桶内的token_id 按时间有序
+        std::map<int64_t, std::vector<uint64_t>> buckets;
+    };
+
+    Shard& shardFor(uint64_t tokenId) { return shards_[tokenId % SHARD_COUNT]; }
+    const Shard& shardFor(uint64_t tokenId) const { return shards_[tokenId % SHARD_COUNT]; }
+    // 在一个分片内清除到期条目 持锁期间最多处理EXPIRE_BATCH个
+    size_t expireShard(Shard& shard, int64_t nowMs, size_t maxEntries);
+
+    std::array<Shard, SHARD_COUNT> shards_;
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> revoked_{0};
+    std::atomic<uint64_t> expired_{0};
+    size_t next_shard_ = 0;  // 只由清理定时器访问 每次从上次停下的分片继续
+    Histogram expire_lock_hold_us_;
+};
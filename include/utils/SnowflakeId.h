@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Snowflake风格的64位id: 1位符号(恒为0) | 41位毫秒时间戳(自EPOCH_MS起) | 10位节点号 | 12位毫秒内序号
+// 同一节点生成的id严格递增 不加锁 多线程并发调用只做CAS
+// 一毫秒内序号用完或时钟回拨时借用下一毫秒 不睡眠等待 时钟追上后恢复正常
+class SnowflakeId {
+public:
+    static constexpr int64_t EPOCH_MS = 1704067200000;  // 2024-01-01 00:00:00 UTC
+    static constexpr int NODE_BITS = 10;
+    static constexpr int SEQUENCE_BITS = 12;
+    static constexpr int64_t MAX_NODE_ID = (int64_t{1} << NODE_BITS) - 1;
+
+    explicit SnowflakeId(int64_t nodeId);
+
+    int64_t next();
+    // 保证之后生成的id都大于id 启动时用库中已有的最大id调用 防止重启后时钟回拨造成重复
+    void observe(int64_t id);
+
+    int64_t nodeId() const { return node_id_; }
+    static int64_t timestampOf(int64_t id) { return (id >> (NODE_BITS + SEQUENCE_BITS)) + EPOCH_MS; }
+
+private:
+    static constexpr int64_t SEQUENCE_MASK = (int64_t{1} << SEQUENCE_BITS) - 1;
+
+    static int64_t nowMs();
+
+    int64_t node_id_;
+    // 上一个id的(时间戳 << SEQUENCE_BITS | 序号) 节点号不变 不用存
+    std::atomic<int64_t> last_{0};
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "utils/Executor.h"
+#include "utils/ExecutorLane.h"
+
+// 串行执行器 投递到同一个Strand的任务按投递顺序逐个执行 不会并发
+// 每个任务可以指定执行通道 相邻任务通道不同时在通道之间接力 顺序仍然保持
+// 不同Strand的任务在执行器中并行 同一时刻一个Strand最多占用一个工作线程
+class Strand : public std::enable_shared_from_this<Strand> {
+public:
+    explicit Strand(Executor& executor);
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    // 在默认执行器上执行
+    void post(Task task);
+    // 在lane上执行 调用方需已通过lane.tryAcquire()占用名额 执行结束后自动释放
+    void post(Task task, ExecutorLane& lane);
+    // 异步任务 任务函数返回后Strand仍保持占用 直到调用complete()才执行后续任务
+    // 用于协程处理函数: 挂起期间释放工作线程 但同一连接的下一条请求不会越过它
+    void postAsync(Task task, ExecutorLane& lane);
+    // 结束当前异步任务 可以在任意线程调用 也可以在任务函数返回前同步调用
+    void complete();
+
+    // 每次占用工作线程最多连续执行的任务数 超过后重新排队 让其他Strand有机会执行
+    static constexpr size_t MAX_BATCH = 16;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        Task task;
+        ExecutorLane* lane = nullptr;
+        Clock::time_point enqueued;
+        bool async = false;
+    };
+
+    void enqueue(Entry entry);
+    void schedule(Executor& executor);
+    void run(Executor* current);
+    Executor& executorFor(const Entry& entry) { return entry.lane ? entry.lane->executor() : executor_; }
+
+    Executor& executor_;
+    std::mutex mutex_;
+    std::deque<Entry> tasks_;
+    bool scheduled_ = false;  // 已提交到执行器或正在执行 异步任务挂起期间也保持为true
+    bool async_running_ = false;  // 异步任务已开始但还没complete()
+    bool suspended_ = false;      // 异步任务函数已返回 等待complete()接着调度
+    ExecutorLane* async_lane_ = nullptr;
+    Clock::time_point async_start_;
+};
@@ -6,24 +6,35 @@
 #include <condition_variable>
 #include <functional>
 #include <atomic>
+#include "utils/Executor.h"
 
-class ThreadPool {
+// 单队列线程池 所有工作线程共享一个加锁的任务队列
+class ThreadPool : public Executor {
 public:
-    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
-    ~ThreadPool();
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency(), ThreadInit init = nullptr);
+    ~ThreadPool() override;
 
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
     ThreadPool(ThreadPool&&) = delete;
     ThreadPool& operator=(ThreadPool&&) = delete;
 
-    void addTask(const std::function<void()>& task);
-    void stop();
+    void addTask(Task task) override;
+    void stop() override;
+    size_t threadCount() const override { return threads_.size(); }
+    const char* name() const override { return "mutex"; }
+    ExecutorStats getStats() const override { return metrics_.snapshot(name()); }
 private:
-    void worker();
+    struct Item {
+        Task task;
+        uint64_t enqueued_us = 0;
+    };
 
+    void worker(size_t index, const ThreadInit& init);
+
+    PoolMetrics metrics_;
     std::vector<std::thread> threads_;
-    std::queue<std::function<void()>> tasks_;
+    std::queue<Item> tasks_;
     std::mutex mutex_;
     std::condition_variable cond_;
     std::atomic<bool> running_{true};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct TokenClaims {
+    int user_id = -1;
+    bool is_admin = false;
+    int64_t expires_ms = 0;   // 过期时间 毫秒时间戳
+    uint64_t token_id = 0;    // 随机编号 注销时按它吊销
+};
+
+// 无状态会话令牌: "<user_id>.<a|u>.<expires_ms>.<token_id hex>.<HMAC-SHA256签名 base64url>"
+// 校验只需要密钥 不访问任何共享状态 可以在任意线程并发调用
+class TokenSigner {
+public:
+    // secret为空时随机生成 此时重启后旧令牌全部失效
+    explicit TokenSigner(const std::string& secret);
+
+    // 随机源失败时返回空串 调用方必须按失败处理
+    std::string issue(int userId, bool isAdmin, int64_t expiresMs, TokenClaims* claims = nullptr) const;
+    // 签名正确且未过期时返回令牌内容
+    std::optional<TokenClaims> verify(std::string_view token, int64_t nowMs) const;
+
+    static constexpr size_t MIN_SECRET_LENGTH = 32;
+
+private:
+    std::string sign(std::string_view payload) const;
+
+    std::string secret_;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "utils/Executor.h"
+
+// 队列中的任务 带入队时间 出队时统计排队时长
+struct QueuedTask {
+    Task task;
+    uint64_t enqueued_us = 0;
+
+    explicit operator bool() const noexcept { return static_cast<bool>(task); }
+};
+
+// Chase-Lev工作窃取双端队列 只有所属线程push/pop底部 其他线程从顶部steal
+// 任务按值存放在槽里 投递不分配堆内存 容量固定 满时push返回false 由调用方改投注入队列
+// 窃取者先用CAS认领下标再把任务移出 移出后才把槽标记为空 所属线程只往空槽里写
+class ChaseLevDeque {
+public:
+    explicit ChaseLevDeque(size_t capacity = 1024);
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    bool push(QueuedTask& task);  // 仅所属线程 成功时task被移走
+    QueuedTask pop();             // 仅所属线程 空时返回空任务
+    QueuedTask steal();           // 任意线程 空或竞争失败时返回空任务
+    bool empty() const;
+
+private:
+    struct Slot {
+        QueuedTask task;
+        std::atomic<bool> full{false};
+    };
+
+    // 认领下标后调用 取出任务并释放槽
+    QueuedTask take(int64_t i);
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+// Vyukov有界MPMC队列 容量必须为2的幂 任务按值存放在环形槽里 满时push返回false
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity);
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    bool push(QueuedTask& task);  // 成功时task被移走
+    QueuedTask pop();             // 空时返回空任务
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        QueuedTask task;
+    };
+
+    size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+// 工作窃取线程池
+// 工作线程内投递的任务进入自己的Chase-Lev队列 外部线程投递的任务进入无锁注入队列
+// 两者满时都退到加锁的溢出队列 任务始终按值移动 投递路径上不分配堆内存
+// 空闲线程先窃取其他线程的任务 自旋一段时间仍无任务才在atomic上等待
+class WorkStealingPool : public Executor {
+public:
+    explicit WorkStealingPool(size_t threadCount = std::thread::hardware_concurrency(), ThreadInit init = nullptr);
+    ~WorkStealingPool() override;
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void addTask(Task task) override;
+    void stop() override;
+    size_t threadCount() const override { return threads_.size(); }
+    const char* name() const override { return "work_stealing"; }
+    ExecutorStats getStats() const override { return metrics_.snapshot(name()); }
+
+private:
+    // 槽按值存放Task 容量决定常驻内存 突发超出的部分进溢出队列
+    static constexpr size_t INJECTION_CAPACITY = 1 << 13;
+    static constexpr int SPIN_ROUNDS = 64;
+
+    struct alignas(64) Worker {
+        ChaseLevDeque deque;
+    };
+
+    void workerLoop(size_t index, const ThreadInit& init);
+    QueuedTask findTask(size_t index, uint64_t& rng);
+    QueuedTask popInjected();
+    void notify();
+
+    PoolMetrics metrics_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    MpmcQueue injection_;
+
+    std::mutex overflow_mutex_;
+    std::deque<QueuedTask> overflow_;
+    std::atomic<size_t> overflow_size_{0};
+    // 所有队列中的任务总数 只用于队列长度统计
+    alignas(64) std::atomic<size_t> queued_{0};
+
+    alignas(64) std::atomic<uint32_t> wake_epoch_{0};
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> running_{true};
+};
@@ -40,14 +40,17 @@ CREATE TABLE rooms (
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
 
 CREATE TABLE messages (
-    message_id INT AUTO_INCREMENT PRIMARY KEY,
+    message_id BIGINT PRIMARY KEY,
     user_id INT NOT NULL,
     room_id INT NOT NULL,
+    room_seq BIGINT NOT NULL,
     content TEXT NOT NULL,
     display_name VARCHAR(15) NOT NULL,
     send_time DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
     
     INDEX idx_room_time (room_id, send_time),
+    INDEX idx_room_message (room_id, message_id),
+    UNIQUE KEY uk_room_seq (room_id, room_seq),
     INDEX idx_user_time (user_id, send_time),
     INDEX idx_send_time (send_time),
     
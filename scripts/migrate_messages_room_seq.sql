@@ -0,0 +1,23 @@
+-- 把旧版messages表(message_id自增 无room_seq)升级到当前结构 需要MySQL 8.0及以上(窗口函数)
+-- 执行前先停掉服务端 迁移期间不能有新消息写入
+-- 新的message_id由服务端按雪花算法分配 启动时从库中最大id之后开始 旧的自增id原样保留
+USE chatroom;
+
+-- 1. message_id改由服务端分配
+ALTER TABLE messages MODIFY message_id BIGINT NOT NULL;
+
+-- 2. 增加房间内序号 按原有的id顺序回填 每个房间从1开始
+ALTER TABLE messages ADD COLUMN room_seq BIGINT NOT NULL DEFAULT 0 AFTER room_id;
+
+UPDATE messages m
+JOIN (
+    SELECT message_id, ROW_NUMBER() OVER (PARTITION BY room_id ORDER BY message_id) AS seq
+    FROM messages
+) numbered ON m.message_id = numbered.message_id
+SET m.room_seq = numbered.seq;
+
+-- 3. 回填完成后再加约束和游标分页用的索引
+ALTER TABLE messages
+    ALTER COLUMN room_seq DROP DEFAULT,
+    ADD UNIQUE KEY uk_room_seq (room_id, room_seq),
+    ADD INDEX idx_room_message (room_id, message_id);
@@ -1,29 +1,159 @@
 #include "dao/MySqlMessageDao.h"
+#include "database/ConnectionPool.h"
+#include <algorithm>
 #include <iostream>
 
+namespace {
+
+constexpr const char* WRITER_LOCK_NAME = "chatroom_message_writer";
+
+}
+
 Message MySqlMessageDao::createFromResultSet(const std::vector<std::string>& row) {
-    return Message{std::stoi(row[0]), std::stoi(row[1]), std::stoi(row[2]), row[3], row[4], row[5]};
+    return Message{std::stoll(row[0]), std::stoi(row[1]), std::stoi(row[2]), std::stoll(row[3]), row[4], row[5], row[6]};
+}
+
+QueryResult<void> MySqlMessageDao::insertMessages(const std::vector<Message>& messages) {
+    if (messages.empty()) return QueryResult<void>::Success();
+
+    QueryResult<ExecuteResult> result = insertRows(messages);
+    if (!result.isInternalError()) return QueryResult<void>::convertFrom(result);
+
+    // 插入失败 可能是上一次提交其实已经成功只是没收到应答 看看哪些id已经在库里
+    auto existing = findExistingIds(messages);
+    if (!existing.isSuccess() || existing.data->empty()) {
+        // 没有已写入的id 冲突来自别处(如room_seq重复) 原样报错
+        return QueryResult<void>::convertFrom(result);
+    }
+    std::vector<Message> remaining;
+    for (const auto& message : messages) {
+        if (std::find(existing.data->begin(), existing.data->end(), message.message_id) == existing.data->end()) {
+            remaining.push_back(message);
+        }
+    }
+    if (remaining.empty()) return QueryResult<void>::Success();
+    return QueryResult<void>::convertFrom(insertRows(remaining));
+}
+
+QueryResult<ExecuteResult> MySqlMessageDao::insertRows(const std::vector<Message>& messages) {
+    std::string sql = "INSERT INTO messages (message_id, user_id, room_id, room_seq, content, display_name, send_time) VALUES ";
+    std::vector<SqlParam> params;
+    params.reserve(messages.size() * 7);
+    for (size_t i = 0; i < messages.size(); ++i) {
+        const auto& message = messages[i];
+        sql += i == 0 ? "(?, ?, ?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?, ?, ?)";
+        params.emplace_back(message.message_id);
+        params.emplace_back(message.user_id);
+        params.emplace_back(message.room_id);
+        params.emplace_back(message.room_seq);
+        params.emplace_back(message.content);
+        params.emplace_back(message.display_name);
+        params.emplace_back(message.send_time);
+    }
+    return execute(sql, params);
 }
 
-QueryResult<void> MySqlMessageDao::sendMessageToRoom(
-    int userId,
+QueryResult<std::vector<int64_t>> MySqlMessageDao::findExistingIds(const std::vector<Message>& messages) {
+    std::string sql = "SELECT message_id FROM messages WHERE message_id IN (";
+    std::vector<SqlParam> params;
+    params.reserve(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        sql += i == 0 ? "?" : ", ?";
+        params.emplace_back(messages[i].message_id);
+    }
+    sql += ")";
+
+    QueryResult<ExecuteResult> result = execute(sql, params);
+    if (result.isNotFound()) return QueryResult<std::vector<int64_t>>::Success(std::vector<int64_t>{});
+    return QueryResult<std::vector<int64_t>>::convertFromMultiple<std::vector<int64_t>>(
+        result,
+        [](const std::vector<std::vector<std::string>>& rows) {
+            std::vector<int64_t> ids;
+            ids.reserve(rows.size());
+            for (const auto& row : rows) ids.push_back(std::stoll(row[0]));
+            return ids;
+        }
+    );
+}
+
+QueryResult<bool> MySqlMessageDao::acquireWriterLock() {
+    if (writer_connection_) return QueryResult<bool>::Success(true);
+
+    auto conn = ConnectionPool::getInstance().getConnection();
+    if (!conn) return QueryResult<bool>::ConnectionError("Failed to get database connection");
+
+    // 连接空闲超时断开会连带释放锁 这个会话上把超时调到最大
+    QueryResult<ExecuteResult> timeout = execute(conn, "SET SESSION wait_timeout = 31536000");
+    if (timeout.isError()) {
+        ConnectionPool::getInstance().releaseConnection(conn);
+        if (timeout.isConnectionError()) return QueryResult<bool>::ConnectionError(timeout.error_message);
+        return QueryResult<bool>::InternalError(timeout.error_message);
+    }
+
+    QueryResult<ExecuteResult> result = execute(conn, "SELECT GET_LOCK(?, 0)", std::string(WRITER_LOCK_NAME));
+    auto locked = QueryResult<bool>::convertFrom<bool>(
+        result,
+        [](const std::vector<std::string>& row) { return !row.empty() && row[0] == "1"; }
+    );
+    if (locked.isSuccess() && *locked.data) {
+        writer_connection_ = std::move(conn);
+    } else {
+        ConnectionPool::getInstance().releaseConnection(conn);
+    }
+    return locked;
+}
+
+QueryResult<int64_t> MySqlMessageDao::getMaxMessageId() {
+    QueryResult<ExecuteResult> result = execute("SELECT COALESCE(MAX(message_id), 0) FROM messages");
+
+    return QueryResult<int64_t>::convertFrom<int64_t>(
+        result,
+        [](const std::vector<std::string>& row) {
+            return static_cast<int64_t>(std::stoll(row[0]));
+        }
+    );
+}
+
+QueryResult<std::vector<std::pair<int, int64_t>>> MySqlMessageDao::getRoomSequences() {
+    QueryResult<ExecuteResult> result = execute("SELECT room_id, MAX(room_seq) FROM messages GROUP BY room_id");
+    if (result.isNotFound()) {
+        return QueryResult<std::vector<std::pair<int, int64_t>>>::Success(std::vector<std::pair<int, int64_t>>{});
+    }
+
+    return QueryResult<std::vector<std::pair<int, int64_t>>>::convertFromMultiple<std::vector<std::pair<int, int64_t>>>(
+        result,
+        [](const std::vector<std::vector<std::string>>& rows) {
+            std::vector<std::pair<int, int64_t>> sequences;
+            sequences.reserve(rows.size());
+            for (const auto& row : rows) {
+                sequences.emplace_back(std::stoi(row[0]), std::stoll(row[1]));
+            }
+            return sequences;
+        }
+    );
+}
+
+QueryResult<void> MySqlMessageDao::streamMessagesBefore(
     int roomId,
-    const std::string& content,
-    const std::string& displayName,
-    const std::string& sendTime
+    int64_t beforeMessageId,
+    int limit,
+    const std::function<bool(const Message&)>& onMessage
 ) {
-    QueryResult<ExecuteResult> result = execute(
-        "INSERT INTO messages (user_id, room_id, content, display_name, send_time) VALUES (?, ?, ?, ?, ?)",
-        userId, roomId, content, displayName, sendTime
+    // 按游标定位而不是OFFSET 翻到多深都只扫描limit行
+    return stream(
+        "SELECT message_id, user_id, room_id, room_seq, content, display_name, send_time "
+        "FROM messages WHERE room_id = ? AND message_id < ? ORDER BY message_id DESC LIMIT ?",
+        {roomId, beforeMessageId, limit},
+        [this, &onMessage](const std::vector<std::string>& row) {
+            return onMessage(createFromResultSet(row));
+        }
     );
-
-    return QueryResult<void>::convertFrom(result);
 }
 
 QueryResult<std::vector<Message>> MySqlMessageDao::getRecentMessages(int roomId, int max_count) {
     QueryResult<ExecuteResult> result = execute(
-        "SELECT message_id, user_id, room_id, content, display_name, send_time "
-        "FROM messages WHERE room_id = ? ORDER BY send_time DESC LIMIT ?",
+        "SELECT message_id, user_id, room_id, room_seq, content, display_name, send_time "
+        "FROM messages WHERE room_id = ? ORDER BY message_id DESC LIMIT ?",
         roomId, max_count
     );
 
@@ -41,8 +171,8 @@ QueryResult<std::vector<Message>> MySqlMessageDao::getRecentMessages(int roomId,
 
 QueryResult<std::vector<Message>> MySqlMessageDao::getRecentMessagesByUser(int userId, int roomId, int max_count) {
     QueryResult<ExecuteResult> result = execute(
-        "SELECT message_id, user_id, room_id, content, display_name, send_time "
-        "FROM messages WHERE user_id = ? AND room_id = ? ORDER BY send_time DESC LIMIT ?",
+        "SELECT message_id, user_id, room_id, room_seq, content, display_name, send_time "
+        "FROM messages WHERE user_id = ? AND room_id = ? ORDER BY message_id DESC LIMIT ?",
         userId, roomId, max_count
     );
     
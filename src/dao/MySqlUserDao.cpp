@@ -169,6 +169,21 @@ QueryResult<User> MySqlUserDao::authenticateUser(const std::string& email, const
     );
 }
 
+QueryResult<UserCredentials> MySqlUserDao::getUserCredentials(const std::string& email) {
+    QueryResult<ExecuteResult> execResult = execute(
+        "SELECT id, discriminator, name, email, is_admin, created_time, password_hash "
+        "FROM users WHERE email = ?",
+        email
+    );
+
+    return QueryResult<UserCredentials>::convertFrom<UserCredentials>(
+        execResult,
+        [this](const std::vector<std::string>& row) {
+            return UserCredentials{createFromResultSet(row), row[6]};
+        }
+    );
+}
+
 QueryResult<User> MySqlUserDao::getUserById(int id) {
     QueryResult<ExecuteResult> execResult = execute(
         "SELECT id, discriminator, name, email, is_admin, created_time "
@@ -0,0 +1,33 @@
+#include "database/AsyncDb.h"
+
+AsyncDb::AsyncDb(std::unique_ptr<Executor> ioExecutor) : io_(std::move(ioExecutor)) {}
+
+AsyncDb::~AsyncDb() {
+    stop();
+}
+
+void AsyncDb::stop() {
+    io_->stop();
+}
+
+void AsyncDb::onSubmit() {
+    uint64_t inFlight = in_flight_.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint64_t peak = peak_in_flight_.load(std::memory_order_relaxed);
+    while (inFlight > peak &&
+           !peak_in_flight_.compare_exchange_weak(peak, inFlight, std::memory_order_relaxed)) {}
+}
+
+void AsyncDb::onComplete() {
+    in_flight_.fetch_sub(1, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+AsyncDbStats AsyncDb::getStats() const {
+    AsyncDbStats stats;
+    stats.threads = io_->threadCount();
+    stats.in_flight = in_flight_.load(std::memory_order_relaxed);
+    stats.peak_in_flight = peak_in_flight_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.pool = io_->getStats();
+    return stats;
+}
@@ -1,4 +1,5 @@
 #include "database/DatabaseManager.h"
+#include "database/PreparedStatement.h"
 #include "utils/EnvLoader.h"
 #include <iostream>
 #include <cstring>
@@ -65,6 +66,217 @@ void DatabaseManager::cleanup() {
     manager.initialized_ = false;
 }
 
+QueryResult<ExecuteResult> DatabaseManager::executeStatement(PreparedStatement& stmt) {
+    if (!stmt.execute()) {
+        std::string error_msg = stmt.getLastError();
+        if (error_msg.empty()) {
+            error_msg = "Failed to execute SQL statement";
+        }
+        return QueryResult<ExecuteResult>::InternalError(error_msg);
+    }
+    
+    MYSQL_RES* meta_result = mysql_stmt_result_metadata(stmt.getStmt());
+    if (!meta_result) {
+        return QueryResult<ExecuteResult>::Success(std::monostate{});
+    }
+    
+    int column_count = mysql_num_fields(meta_result);
+    if (column_count == 0) {
+        mysql_free_result(meta_result);
+        return QueryResult<ExecuteResult>::Success(std::monostate{});
+    }
+    
+    if (mysql_stmt_store_result(stmt.getStmt()) != 0) {
+        mysql_free_result(meta_result);
+        return QueryResult<ExecuteResult>::InternalError("Failed to store result");
+    }
+    
+    my_ulonglong row_count = mysql_stmt_num_rows(stmt.getStmt());
+    
+    std::vector<MYSQL_BIND> result_binds(column_count);
+    std::vector<std::string> string_buffers(column_count);
+    std::vector<unsigned long> lengths(column_count);
+    
+    memset(result_binds.data(), 0, sizeof(MYSQL_BIND) * column_count);
+    
+    const size_t initial_buffer_size = 1024;
+    
+    for (int i = 0; i < column_count; ++i) {
+        string_buffers[i].resize(initial_buffer_size);
+        result_binds[i].buffer_type = MYSQL_TYPE_STRING;
+        result_binds[i].buffer = string_buffers[i].data();
+        result_binds[i].buffer_length = initial_buffer_size;
+        result_binds[i].length = &lengths[i];
+    }
+    
+    mysql_free_result(meta_result);
+    
+    if (mysql_stmt_bind_result(stmt.getStmt(), result_binds.data()) != 0) {
+        return QueryResult<ExecuteResult>::InternalError("Failed to bind result");
+    }
+    
+    if (row_count == 0) {
+        return QueryResult<ExecuteResult>::NotFound();
+    } else if (row_count == 1) {
+        int fetch_result = mysql_stmt_fetch(stmt.getStmt());
+        if (fetch_result != 0) {
+            return QueryResult<ExecuteResult>::InternalError("Failed to fetch single row");
+        }
+        
+        std::vector<std::string> row;
+        row.reserve(column_count);
+        for (int i = 0; i < column_count; ++i) {
+            row.emplace_back(string_buffers[i].data(), lengths[i]);
+        }
+        
+        return QueryResult<ExecuteResult>::Success(row);
+    } else {
+        std::vector<std::vector<std::string>> results;
+        
+        while (true) {
+            int fetch_result = mysql_stmt_fetch(stmt.getStmt());
+            if (fetch_result == 0) {
+                std::vector<std::string> row;
+                row.reserve(column_count);
+                for (int i = 0; i < column_count; ++i) {
+                    row.emplace_back(string_buffers[i].data(), lengths[i]);
+                }
+                results.push_back(std::move(row));
+            } else if (fetch_result == MYSQL_NO_DATA) {
+                break;
+            } else {
+                return QueryResult<ExecuteResult>::InternalError("Failed to fetch rows");
+            }
+        }
+        
+        return QueryResult<ExecuteResult>::Success(results);
+    }
+}
+
+QueryResult<ExecuteResult> DatabaseManager::execute(const std::string& sql, const std::vector<SqlParam>& params) {
+    if (!initialized_) {
+        return QueryResult<ExecuteResult>::InternalError("Database not initialized");
+    }
+
+    auto conn = ConnectionPool::getInstance().getConnection();
+    if (!conn) {
+        return QueryResult<ExecuteResult>::ConnectionError("Failed to get database connection");
+    }
+
+    auto result = execute(conn, sql, params);
+    ConnectionPool::getInstance().releaseConnection(conn);
+    return result;
+}
+
+QueryResult<ExecuteResult> DatabaseManager::execute(std::shared_ptr<DatabaseConnection> conn, const std::string& sql, const std::vector<SqlParam>& params) {
+    if (!initialized_ || !conn) {
+        return QueryResult<ExecuteResult>::InternalError("Database not initialized or invalid connection");
+    }
+
+    try {
+        PreparedStatement stmt(conn, sql, static_cast<int>(params.size()));
+        for (const auto& param : params) {
+            stmt.bind(param);
+        }
+        return executeStatement(stmt);
+    } catch (const std::exception& e) {
+        return QueryResult<ExecuteResult>::InternalError(std::string("Exception: ") + e.what());
+    }
+}
+
+QueryResult<void> DatabaseManager::stream(const std::string& sql, const std::vector<SqlParam>& params, const RowCallback& onRow) {
+    if (!initialized_) {
+        return QueryResult<void>::InternalError("Database not initialized");
+    }
+
+    auto conn = ConnectionPool::getInstance().getConnection();
+    if (!conn) {
+        return QueryResult<void>::ConnectionError("Failed to get database connection");
+    }
+
+    QueryResult<void> result = QueryResult<void>::Success();
+    try {
+        PreparedStatement stmt(conn, sql, static_cast<int>(params.size()));
+        for (const auto& param : params) {
+            stmt.bind(param);
+        }
+        result = streamStatement(stmt, onRow);
+    } catch (const std::exception& e) {
+        result = QueryResult<void>::InternalError(std::string("Exception: ") + e.what());
+    }
+    ConnectionPool::getInstance().releaseConnection(conn);
+    return result;
+}
+
+QueryResult<void> DatabaseManager::streamStatement(PreparedStatement& stmt, const RowCallback& onRow) {
+    if (!stmt.execute()) {
+        std::string error_msg = stmt.getLastError();
+        if (error_msg.empty()) {
+            error_msg = "Failed to execute SQL statement";
+        }
+        return QueryResult<void>::InternalError(error_msg);
+    }
+
+    MYSQL_RES* meta_result = mysql_stmt_result_metadata(stmt.getStmt());
+    if (!meta_result) {
+        return QueryResult<void>::Success();
+    }
+    int column_count = mysql_num_fields(meta_result);
+    mysql_free_result(meta_result);
+    if (column_count == 0) {
+        return QueryResult<void>::Success();
+    }
+
+    std::vector<MYSQL_BIND> result_binds(column_count);
+    std::vector<std::string> string_buffers(column_count);
+    std::vector<unsigned long> lengths(column_count);
+    memset(result_binds.data(), 0, sizeof(MYSQL_BIND) * column_count);
+
+    const size_t initial_buffer_size = 1024;
+    for (int i = 0; i < column_count; ++i) {
+        string_buffers[i].resize(initial_buffer_size);
+        result_binds[i].buffer_type = MYSQL_TYPE_STRING;
+        result_binds[i].buffer = string_buffers[i].data();
+        result_binds[i].buffer_length = initial_buffer_size;
+        result_binds[i].length = &lengths[i];
+    }
+
+    // 不调用mysql_stmt_store_result 行从服务端逐行读取
+    if (mysql_stmt_bind_result(stmt.getStmt(), result_binds.data()) != 0) {
+        return QueryResult<void>::InternalError("Failed to bind result");
+    }
+
+    std::vector<std::string> row(column_count);
+    while (true) {
+        int fetch_result = mysql_stmt_fetch(stmt.getStmt());
+        if (fetch_result == MYSQL_NO_DATA) break;
+        if (fetch_result != 0 && fetch_result != MYSQL_DATA_TRUNCATED) {
+            return QueryResult<void>::InternalError("Failed to fetch rows");
+        }
+
+        for (int i = 0; i < column_count; ++i) {
+            if (lengths[i] <= initial_buffer_size) {
+                row[i].assign(string_buffers[i].data(), lengths[i]);
+                continue;
+            }
+            // 超出缓冲区的列(如长消息)按实际长度单独再取一次
+            row[i].resize(lengths[i]);
+            MYSQL_BIND column_bind;
+            memset(&column_bind, 0, sizeof(column_bind));
+            column_bind.buffer_type = MYSQL_TYPE_STRING;
+            column_bind.buffer = row[i].data();
+            column_bind.buffer_length = lengths[i];
+            if (mysql_stmt_fetch_column(stmt.getStmt(), &column_bind, i, 0) != 0) {
+                return QueryResult<void>::InternalError("Failed to fetch column");
+            }
+        }
+
+        // 提前结束时未读的行在语句关闭时丢弃
+        if (!onRow(row)) break;
+    }
+    return QueryResult<void>::Success();
+}
+
 template QueryResult<ExecuteResult> DatabaseManager::execute(const std::string&, const std::string&);
 template QueryResult<ExecuteResult> DatabaseManager::execute(const std::string&, int);
 template QueryResult<ExecuteResult> DatabaseManager::execute(const std::string&, const std::string&, int);
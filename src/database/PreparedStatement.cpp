@@ -41,6 +41,16 @@ PreparedStatement& PreparedStatement::bind(int value) {
     return *this;
 }
 
+PreparedStatement& PreparedStatement::bind(int64_t value) {
+    if (current_param_idx_ < param_binds_.size()) {
+        param_values_[current_param_idx_] = value;
+        param_binds_[current_param_idx_].buffer_type = MYSQL_TYPE_LONGLONG;
+        param_binds_[current_param_idx_].buffer = &std::get<int64_t>(param_values_[current_param_idx_]);
+        current_param_idx_++;
+    }
+    return *this;
+}
+
 PreparedStatement& PreparedStatement::bind(const std::string& value) {
     if (current_param_idx_ < param_binds_.size()) {
         // 直接存储字符串，保持类型一致性
@@ -78,6 +88,10 @@ PreparedStatement& PreparedStatement::bind(bool value) {
     return *this;
 }
 
+PreparedStatement& PreparedStatement::bind(const std::variant<int, int64_t, double, std::string>& value) {
+    return std::visit([this](const auto& v) -> PreparedStatement& { return bind(v); }, value);
+}
+
 bool PreparedStatement::execute() {
     if (!param_binds_.empty()) {
         if (mysql_stmt_bind_param(stmt_, param_binds_.data()) != 0) {
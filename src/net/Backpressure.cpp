@@ -0,0 +1,45 @@
+#include "net/Backpressure.h"
+#include <algorithm>
+
+BackpressureController::BackpressureController(BackpressureConfig config) : config_(std::move(config)) {
+    config_.low_watermark = std::min(config_.low_watermark, config_.high_watermark);
+    config_.hard_limit = std::max(config_.hard_limit, config_.high_watermark);
+}
+
+void BackpressureController::recordDropped(size_t frames, size_t bytes) {
+    dropped_frames_.fetch_add(frames, std::memory_order_relaxed);
+    dropped_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void BackpressureController::recordCoalesced(size_t frames, size_t bytes) {
+    coalesced_frames_.fetch_add(frames, std::memory_order_relaxed);
+    dropped_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+BackpressureStats BackpressureController::getStats() const {
+    BackpressureStats stats;
+    stats.queued_bytes = static_cast<uint64_t>(std::max<int64_t>(0, queued_bytes_.load(std::memory_order_relaxed)));
+    stats.congestion_events = congestion_events_.load(std::memory_order_relaxed);
+    stats.dropped_frames = dropped_frames_.load(std::memory_order_relaxed);
+    stats.dropped_bytes = dropped_bytes_.load(std::memory_order_relaxed);
+    stats.coalesced_frames = coalesced_frames_.load(std::memory_order_relaxed);
+    stats.budget_rejections = budget_rejections_.load(std::memory_order_relaxed);
+    stats.disconnects = disconnects_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::optional<BackpressurePolicy> BackpressureController::parsePolicy(const std::string& name) {
+    if (name == "drop_oldest") return BackpressurePolicy::DropOldest;
+    if (name == "coalesce") return BackpressurePolicy::Coalesce;
+    if (name == "disconnect") return BackpressurePolicy::Disconnect;
+    return std::nullopt;
+}
+
+const char* BackpressureController::policyName(BackpressurePolicy policy) {
+    switch (policy) {
+        case BackpressurePolicy::DropOldest: return "drop_oldest";
+        case BackpressurePolicy::Coalesce: return "coalesce";
+        case BackpressurePolicy::Disconnect: return "disconnect";
+    }
+    return "unknown";
+}
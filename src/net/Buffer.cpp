@@ -0,0 +1,76 @@
+#include "net/Buffer.h"
+#include <algorithm>
+#include <cstring>
+
+Buffer::Buffer(size_t initialSize)
+    : storage_(std::make_shared<BufferStorage>(initialSize)),
+      capacity_(initialSize),
+      initial_size_(initialSize),
+      read_index_(0),
+      write_index_(0) {}
+
+void Buffer::ensureWritable(size_t len) {
+    if (writableBytes() < len) {
+        makeSpace(len);
+    }
+}
+
+void Buffer::append(const char* data, size_t len) {
+    ensureWritable(len);
+    std::memcpy(beginWrite(), data, len);
+    hasWritten(len);
+}
+
+void Buffer::retrieve(size_t len) {
+    if (len >= readableBytes()) {
+        retrieveAll();
+        return;
+    }
+    read_index_ += len;
+}
+
+void Buffer::retrieveAll() {
+    // 有切片引用时不能复用头部空间 留给makeSpace换存储
+    if (isShared()) {
+        read_index_ = write_index_;
+        return;
+    }
+    read_index_ = 0;
+    write_index_ = 0;
+}
+
+BufferSlice Buffer::retrieveAsSlice(size_t len) {
+    len = std::min(len, readableBytes());
+    BufferSlice slice(storage_, peek(), len);
+    read_index_ += len;
+    return slice;
+}
+
+void Buffer::clear() {
+    storage_ = std::make_shared<BufferStorage>(initial_size_);
+    capacity_ = initial_size_;
+    read_index_ = 0;
+    write_index_ = 0;
+}
+
+void Buffer::makeSpace(size_t len) {
+    size_t readable = readableBytes();
+
+    // 存储独占且整理后空间足够 原地搬移未读数据
+    if (!isShared() && read_index_ + writableBytes() >= len && readable < capacity_ / 2) {
+        std::memmove(storage_->bytes.get(), peek(), readable);
+        read_index_ = 0;
+        write_index_ = readable;
+        return;
+    }
+
+    // 被切片引用时保持原容量换一块新存储 独占时按倍数扩容
+    size_t newCapacity = std::max(readable + len, isShared() ? capacity_ : capacity_ * 2);
+
+    auto storage = std::make_shared<BufferStorage>(newCapacity);
+    std::memcpy(storage->bytes.get(), peek(), readable);
+    storage_ = std::move(storage);
+    capacity_ = newCapacity;
+    read_index_ = 0;
+    write_index_ = readable;
+}
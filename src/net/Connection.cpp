@@ -1,51 +1,162 @@
 #include "net/Connection.h"
+#include "net/TimerWheel.h"
 #include <unistd.h>
 #include <cstring>
 #include <arpa/inet.h>
+#include <sys/socket.h>
 #include <errno.h>
 #include <iostream>
 #include <algorithm>
 
-Connection::Connection(int fd) : fd_(fd) {}
+Connection::Connection(int fd, int loopIndex)
+    : fd_(fd), loop_index_(loopIndex), last_active_ms_(TimerWheel::nowMs()) {}
 
 Connection::~Connection() {
     std::lock_guard<std::mutex> lock(mutex_);
-    read_buffer_.clear();
-    write_buffer_.clear();
+    read_buffer_.retrieveAll();
+    write_queue_.clear();
+    accountQueuedBytes();
+}
+
+void Connection::adaptReadSize(size_t lastRead, size_t eventTotal) {
+    if (lastRead >= read_size_) {
+        // 读满说明还有更多数据 下次读大一些
+        read_size_ = std::min(read_size_ * 2, MAX_READ_SIZE);
+    } else if (eventTotal < read_size_ / 4) {
+        // 一次就绪事件连1/4都读不满 连接比较空闲 缩小
+        read_size_ = std::max(read_size_ / 2, MIN_READ_SIZE);
+    }
+}
+
+SharedFrame Connection::encodeFrame(uint16_t type, std::string_view data) {
+    if (data.length() > MAX_MESSAGE_LENGTH) {
+        return nullptr;
+    }
+
+    auto frame = std::make_shared<std::string>();
+    frame->reserve(HEADER_SIZE + data.length());
+
+    uint16_t msgType = htons(type);
+    uint16_t length  = htons(data.length());
+    frame->append(reinterpret_cast<const char*>(&msgType), sizeof(msgType));
+    frame->append(reinterpret_cast<const char*>(&length),  sizeof(length));
+    frame->append(data);
+    return frame;
 }
 
 std::vector<NetworkMessage> Connection::extractMessages() {
     std::vector<NetworkMessage> messages;
     std::lock_guard<std::mutex> lock(mutex_);
     
-    while (read_buffer_.size() >= HEADER_SIZE) {
+    while (read_buffer_.readableBytes() >= HEADER_SIZE) {
         uint16_t type, length;
-        std::memcpy(&type, read_buffer_.data(), sizeof(type));
-        std::memcpy(&length, read_buffer_.data() + 2, sizeof(length));
+        std::memcpy(&type, read_buffer_.peek(), sizeof(type));
+        std::memcpy(&length, read_buffer_.peek() + 2, sizeof(length));
         type = ntohs(type);
         length = ntohs(length);
         
         // 无完整消息 等待更多数据
-        if (read_buffer_.size() < HEADER_SIZE + length) {
+        if (read_buffer_.readableBytes() < HEADER_SIZE + length) {
             break;
         }
         
-        messages.emplace_back(type, read_buffer_.substr(HEADER_SIZE, length));
-        read_buffer_.erase(0, HEADER_SIZE + length);
+        read_buffer_.retrieve(HEADER_SIZE);
+        messages.emplace_back(type, read_buffer_.retrieveAsSlice(length));
     }
     return messages;
 }
 
 void Connection::appendToWriteBuffer(const std::string& data) {
+    sendFrame(std::make_shared<const std::string>(data));
+}
+
+void Connection::setBackpressure(BackpressureController* controller) {
     std::lock_guard<std::mutex> lock(mutex_);
+    backpressure_ = controller;
+}
+
+void Connection::accountQueuedBytes() {
+    if (!backpressure_) return;
+    size_t now = write_queue_.bytes();
+    backpressure_->addQueued(static_cast<int64_t>(now) - static_cast<int64_t>(accounted_bytes_));
+    accounted_bytes_ = now;
+}
+
+bool Connection::admitFrame(const SharedFrame& frame, bool& closing) {
+    if (!backpressure_) return true;
+
+    const auto& config = backpressure_->config();
+    size_t size = frame->size();
+    size_t queued = write_queue_.bytes();
+
+    // 高低水位之间保持拥塞状态 避免在临界点反复切换
+    if (congested_ && queued <= config.low_watermark) {
+        congested_ = false;
+    }
+    if (!congested_ && queued + size > config.high_watermark) {
+        congested_ = true;
+        backpressure_->recordCongestion();
+    }
+    bool overBudget = backpressure_->overBudget(size);
+    if (!congested_ && !overBudget) return true;
 
-    if (write_buffer_.size() + data.size() > MAX_WRITE_BUFFER_SIZE) {
-        return;
+    FrameClass frameClass = backpressure_->classify(WriteQueue::frameType(*frame));
+    bool essential = frameClass == FrameClass::Essential;
+
+    if ((congested_ && config.policy == BackpressurePolicy::Disconnect) ||
+        (essential && queued + size > config.hard_limit)) {
+        // 队列里的内容已经没有意义 清空后只留通知 不在锁内发送 由事件循环写出通知后关闭连接
+        write_queue_.clear();
+        if (config.disconnect_notice) {
+            write_queue_.push(config.disconnect_notice);
+        }
+        closing_.store(true, std::memory_order_release);
+        closing = true;
+        backpressure_->recordDisconnect();
+        return false;
+    }
+
+    // 必需帧不受水位和预算限制 只受hard_limit约束
+    if (essential) return true;
+
+    if (overBudget) {
+        backpressure_->recordBudgetRejection();
+        backpressure_->recordDropped(1, size);
+        return false;
+    }
+
+    uint16_t type = WriteQueue::frameType(*frame);
+    if (frameClass == FrameClass::Coalescable && config.policy == BackpressurePolicy::Coalesce) {
+        auto coalesced = write_queue_.dropOldest([type](uint16_t t) { return t == type; }, 0);
+        if (coalesced.frames > 0) {
+            backpressure_->recordCoalesced(coalesced.frames, coalesced.bytes);
+        }
+    }
+
+    // 拥塞期间为新推送腾位置: 丢弃最旧的可丢弃帧 把队列压回低水位
+    // Coalesce策略下状态推送每种只剩一条 不参与丢弃
+    if (write_queue_.bytes() + size > config.low_watermark) {
+        size_t target = config.low_watermark > size ? config.low_watermark - size : 1;
+        auto* controller = backpressure_;
+        bool keepCoalescable = config.policy == BackpressurePolicy::Coalesce;
+        auto dropped = write_queue_.dropOldest([controller, keepCoalescable](uint16_t t) {
+            FrameClass c = controller->classify(t);
+            return c == FrameClass::Droppable || (c == FrameClass::Coalescable && !keepCoalescable);
+        }, target);
+        if (dropped.frames > 0) {
+            backpressure_->recordDropped(dropped.frames, dropped.bytes);
+        }
     }
-    write_buffer_.append(data);
+
+    // 队列被必需帧占满 没有可丢弃的空间 丢弃这条新推送
+    if (write_queue_.bytes() + size > config.high_watermark) {
+        backpressure_->recordDropped(1, size);
+        return false;
+    }
+    return true;
 }
 
-SendResult Connection::sendFromWriteBuffer(int fd, size_t maxLen) {
+SendResult Connection::sendFromWriteBuffer(int fd) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     SendResult result;
@@ -53,28 +164,15 @@ SendResult Connection::sendFromWriteBuffer(int fd, size_t maxLen) {
     result.has_more_data = false;
     result.error = false;
     
-    if (write_buffer_.empty()) {
-        return result;
-    }
-    
-    size_t len = std::min(maxLen, write_buffer_.size());
-    ssize_t n = send(fd, write_buffer_.data(), len, 0);
-    
-    if (n < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            result.error = false; // 不是真正的错误
-        } else {
-            result.error = true;
-        }
+    if (closed_ || write_queue_.empty()) {
         return result;
     }
     
-    result.bytes_sent = n;
-    if (n > 0) {
-        write_buffer_.erase(0, n);
-    }
-    
-    result.has_more_data = !write_buffer_.empty();
+    auto flushed = write_queue_.flush(fd);
+    accountQueuedBytes();
+    result.bytes_sent = flushed.bytes_sent;
+    result.error = flushed.error;   // EAGAIN不是真正的错误
+    result.has_more_data = !write_queue_.empty();
     return result;
 }
 
@@ -86,17 +184,20 @@ ReadResult Connection::recvToReadBuffer(int fd, size_t maxLen) {
     result.error = false;
     result.connection_closed = false;
     
-    if (read_buffer_.size() + maxLen >= MAX_READ_BUFFER_SIZE) {
+    if (closed_) {
+        result.connection_closed = true;
+        return result;
+    }
+    
+    if (read_buffer_.readableBytes() + maxLen >= MAX_READ_BUFFER_SIZE) {
         result.error = true;
         return result;
     }
     
-    size_t original_size = read_buffer_.size();
-    read_buffer_.resize(original_size + maxLen);
-    ssize_t n = recv(fd, &read_buffer_[original_size], maxLen, 0);
+    read_buffer_.ensureWritable(maxLen);
+    ssize_t n = recv(fd, read_buffer_.beginWrite(), maxLen, 0);
     
     if (n < 0) {
-        read_buffer_.resize(original_size);
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             result.error = false;
         } else {
@@ -104,36 +205,97 @@ ReadResult Connection::recvToReadBuffer(int fd, size_t maxLen) {
         }
         return result;
     } else if (n == 0) {
-        read_buffer_.resize(original_size);
         result.connection_closed = true;
         return result;
     }
     
-    read_buffer_.resize(original_size + n);
+    read_buffer_.hasWritten(n);
     result.bytes_read = n;
     return result;
 }
 
 void Connection::sendMessage(uint16_t type, const std::string& data) {
+    sendFrame(encodeFrame(type, data));
+}
+
+void Connection::sendFrame(const SharedFrame& frame) {
+    if (!frame) return;
+    bool pending;
+    bool closing = false;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        
-        if (data.length() > MAX_MESSAGE_LENGTH) {
-            return;
+        if (closing_.load(std::memory_order_relaxed) || closed_) return;
+
+        bool wasEmpty = write_queue_.empty();
+        if (admitFrame(frame, closing)) {
+            write_queue_.push(frame);
+            // 队列原本为空时直接在当前线程尝试非阻塞发送 空闲连接的回复只需一次sendmsg
+            // 持有mutex_且队列为空 不会与循环线程的刷新交错 帧序不变
+            if (wasEmpty) {
+                write_queue_.flush(fd_);
+            }
         }
-        
-        write_buffer_.reserve(write_buffer_.size() + HEADER_SIZE + data.length());
+        accountQueuedBytes();
+        // 没发完(EAGAIN)或出错都交给事件循环 出错时由循环线程的刷新发现并清理连接
+        // 进入关闭中状态时也要交给事件循环 由它写出断开通知再关闭
+        pending = !write_queue_.empty() || closing;
+    }
+    if (pending) requestFlush();
+}
+
+bool Connection::queueFrame(const SharedFrame& frame) {
+    if (!frame) return false;
+    bool closing = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_.load(std::memory_order_relaxed) || closed_) return false;
+    if (admitFrame(frame, closing)) {
+        write_queue_.push(frame);
+    }
+    accountQueuedBytes();
+    return true;
+}
+
+void Connection::flushQueued() {
+    bool pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return;
+        bool closing = closing_.load(std::memory_order_relaxed);
+        // 持有mutex_发送 与循环线程的刷新不会交错 关闭中的连接只交给事件循环写出断开通知
+        if (!closing && !write_queue_.empty()) {
+            write_queue_.flush(fd_);
+            accountQueuedBytes();
+        }
+        pending = !write_queue_.empty() || closing;
+    }
+    if (pending) requestFlush();
+}
 
-        uint16_t msgType = htons(type);
-        uint16_t length  = htons(data.length());
-        write_buffer_.append(reinterpret_cast<const char*>(&msgType), sizeof(msgType));
-        write_buffer_.append(reinterpret_cast<const char*>(&length),  sizeof(length));
-        write_buffer_.append(data);
+void Connection::requestFlush() {
+    if (write_callback_ && !flush_queued_.exchange(true, std::memory_order_acq_rel)) {
+        write_callback_(fd_, generation_);
     }
-    if (write_callback_) write_callback_(fd_);
 }
 
-void Connection::setWriteEventCallback(std::function<void(int)> callback) {
+void Connection::closeAfterFlush(const SharedFrame& notice) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || closing_.load(std::memory_order_relaxed)) return;
+        if (notice) {
+            write_queue_.push(notice);
+            accountQueuedBytes();
+        }
+        closing_.store(true, std::memory_order_release);
+    }
+    requestFlush();
+}
+
+void Connection::markClosed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+}
+
+void Connection::setWriteEventCallback(std::function<void(int, uint32_t)> callback) {
     std::lock_guard<std::mutex> lock(mutex_);
     write_callback_ = std::move(callback);
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "net/ConnectionTable.h"
+#include <sys/resource.h>
+#include <algorithm>
+
+namespace {
+
+constexpr size_t MAX_AUTO_CAPACITY = 1 << 20;
+
+size_t defaultCapacity() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+        return MAX_AUTO_CAPACITY;
+    }
+    return std::min<size_t>(limit.rlim_cur, MAX_AUTO_CAPACITY);
+}
+
+}
+
+ConnectionTable::ConnectionTable(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : defaultCapacity()),
+      chunk_count_((capacity_ + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      chunks_(new std::atomic<Slot*>[chunk_count_]) {
+    for (size_t i = 0; i < chunk_count_; ++i) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ConnectionTable::~ConnectionTable() {
+    for (size_t i = 0; i < chunk_count_; ++i) {
+        delete[] chunks_[i].load(std::memory_order_relaxed);
+    }
+}
+
+ConnectionTable::Slot* ConnectionTable::find(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= capacity_) return nullptr;
+    Slot* chunk = chunks_[fd / CHUNK_SIZE].load(std::memory_order_acquire);
+    return chunk ? &chunk[fd % CHUNK_SIZE] : nullptr;
+}
+
+ConnectionTable::Slot* ConnectionTable::findOrCreate(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= capacity_) return nullptr;
+    auto& entry = chunks_[fd / CHUNK_SIZE];
+    Slot* chunk = entry.load(std::memory_order_acquire);
+    if (!chunk) {
+        // 只有新块的第一次写入走这里 加锁避免两个线程各分配一块
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        chunk = entry.load(std::memory_order_acquire);
+        if (!chunk) {
+            chunk = new Slot[CHUNK_SIZE];
+            entry.store(chunk, std::memory_order_release);
+            allocated_chunks_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return &chunk[fd % CHUNK_SIZE];
+}
+
+bool ConnectionTable::insert(int fd, const std::shared_ptr<Connection>& connection) {
+    Slot* slot = findOrCreate(fd);
+    if (!slot) return false;
+
+    uint32_t generation = slot->next_generation.fetch_add(1, std::memory_order_relaxed);
+    connection->setGeneration(generation);
+    auto previous = slot->connection.exchange(connection, std::memory_order_acq_rel);
+    if (!previous) size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+std::shared_ptr<Connection> ConnectionTable::get(int fd) const {
+    Slot* slot = find(fd);
+    return slot ? slot->connection.load(std::memory_order_acquire) : nullptr;
+}
+
+std::shared_ptr<Connection> ConnectionTable::get(int fd, uint32_t generation) const {
+    auto connection = get(fd);
+    if (connection && connection->getGeneration() != generation) return nullptr;
+    return connection;
+}
+
+std::shared_ptr<Connection> ConnectionTable::remove(int fd, uint32_t generation) {
+    Slot* slot = find(fd);
+    if (!slot) return nullptr;
+
+    auto current = slot->connection.load(std::memory_order_acquire);
+    while (current && current->getGeneration() == generation) {
+        if (slot->connection.compare_exchange_weak(current, nullptr, std::memory_order_acq_rel)) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return current;
+        }
+    }
+    return nullptr;
+}
+
+void ConnectionTable::clear() {
+    for (size_t i = 0; i < chunk_count_; ++i) {
+        Slot* chunk = chunks_[i].load(std::memory_order_acquire);
+        if (!chunk) continue;
+        for (size_t j = 0; j < CHUNK_SIZE; ++j) {
+            if (chunk[j].connection.exchange(nullptr, std::memory_order_acq_rel)) {
+                size_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
@@ -2,25 +2,37 @@
 #include <stdexcept>
 #include <unistd.h>
 #include <errno.h>
+#include <algorithm>
 
-EpollPoller::EpollPoller(int maxEvents) : events_(maxEvents) {
+EpollPoller::EpollPoller(int maxEvents) : events_(std::max(maxEvents, 1)) {
     epfd_ = epoll_create1(0);
     if (epfd_ < 0) throw std::runtime_error("epoll_create1 failed");
 }
 EpollPoller::~EpollPoller() { close(epfd_); }
 
-bool EpollPoller::addFd(int fd, uint32_t ev) {
-    epoll_event e{.events = ev, .data = {.fd = fd}};
+bool EpollPoller::addFd(int fd, uint32_t ev, uint32_t tag) {
+    epoll_event e{.events = ev, .data = {.u64 = packData(fd, tag)}};
     return epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &e) == 0;
 }
-bool EpollPoller::modifyFd(int fd, uint32_t ev) {
-    epoll_event e{.events = ev, .data = {.fd = fd}};
+bool EpollPoller::modifyFd(int fd, uint32_t ev, uint32_t tag) {
+    epoll_event e{.events = ev, .data = {.u64 = packData(fd, tag)}};
     return epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &e) == 0;
 }
 bool EpollPoller::removeFd(int fd) {
     return epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr) == 0;
 }
-std::vector<epoll_event> EpollPoller::poll(int timeout) {
-    int n = epoll_wait(epfd_, events_.data(), events_.size(), timeout);
-    return std::vector<epoll_event>(events_.begin(), events_.begin() + n);
+std::span<const epoll_event> EpollPoller::poll(int timeout) {
+    if (grow_) {
+        events_.resize(events_.size() * 2);
+        grow_ = false;
+    }
+    int n = epoll_wait(epfd_, events_.data(), static_cast<int>(events_.size()), timeout);
+    if (n <= 0) {
+        return {};
+    }
+    if (static_cast<size_t>(n) == events_.size() && events_.size() < MAX_EVENTS_CAPACITY) {
+        // 本轮被填满 说明可能还有就绪事件没取到 下一轮poll前扩容(此时上一轮的视图已失效)
+        grow_ = true;
+    }
+    return {events_.data(), static_cast<size_t>(n)};
 }
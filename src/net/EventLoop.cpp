@@ -0,0 +1,138 @@
+#include "net/EventLoop.h"
+#include "net/EpollPoller.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+
+namespace {
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+}
+
+}
+
+EventLoop::EventLoop(int index, int listenFd, int timeoutMs)
+    : index_(index), listen_fd_(listenFd), timeout_ms_(timeoutMs), poller_(std::make_unique<EpollPoller>()) {
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        throw std::runtime_error("eventfd failed: " + std::string(strerror(errno)));
+    }
+    poller_->addFd(wakeup_fd_, EPOLLIN);
+    poller_->addFd(listen_fd_, EPOLLIN | EPOLLET);
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    join();
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+    }
+    close(wakeup_fd_);
+}
+
+void EventLoop::start(EventHandler handler) {
+    thread_ = std::thread([this, handler = std::move(handler)]() {
+        run(handler);
+    });
+}
+
+void EventLoop::run(EventHandler handler) {
+    thread_id_ = std::this_thread::get_id();
+    if (thread_init_) thread_init_();
+    // 稳态下整个循环不做堆分配: 事件视图指向Poller内部数组 deferred_两个数组交换复用
+    while (running_) {
+        auto pollStart = std::chrono::steady_clock::now();
+        int timeout = deferred_.empty() ? timers_.nextTimeoutMs(TimerWheel::nowMs(), timeout_ms_) : 0;
+        auto events = poller_->poll(timeout);
+        auto pollEnd = std::chrono::steady_clock::now();
+        for (const auto& ev : events) {
+            if (Poller::eventFd(ev) == wakeup_fd_) {
+                handleWakeup();
+                continue;
+            }
+            handler(*this, ev);
+        }
+
+        if (!deferred_.empty()) {
+            deferred_dispatching_.swap(deferred_);
+            for (auto& ev : deferred_dispatching_) {
+                handler(*this, ev);
+            }
+            deferred_dispatching_.clear();
+        }
+
+        timers_.advance(TimerWheel::nowMs());
+
+        uint64_t blocked = elapsedUs(pollStart, pollEnd);
+        uint64_t processing = elapsedUs(pollEnd, std::chrono::steady_clock::now());
+        iterations_.fetch_add(1, std::memory_order_relaxed);
+        total_events_.fetch_add(events.size(), std::memory_order_relaxed);
+        total_blocked_us_.fetch_add(blocked, std::memory_order_relaxed);
+        total_processing_us_.fetch_add(processing, std::memory_order_relaxed);
+        last_events_.store(events.size(), std::memory_order_relaxed);
+        last_blocked_us_.store(blocked, std::memory_order_relaxed);
+        last_processing_us_.store(processing, std::memory_order_relaxed);
+    }
+}
+
+LoopStats EventLoop::getStats() const {
+    LoopStats stats;
+    stats.iterations = iterations_.load(std::memory_order_relaxed);
+    stats.events = total_events_.load(std::memory_order_relaxed);
+    stats.blocked_us = total_blocked_us_.load(std::memory_order_relaxed);
+    stats.processing_us = total_processing_us_.load(std::memory_order_relaxed);
+    stats.last_events = last_events_.load(std::memory_order_relaxed);
+    stats.last_blocked_us = last_blocked_us_.load(std::memory_order_relaxed);
+    stats.last_processing_us = last_processing_us_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void EventLoop::stop() {
+    running_ = false;
+    wakeup();
+}
+
+void EventLoop::queueFlush(int fd, uint32_t generation) {
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        first = pending_flush_.empty();
+        pending_flush_.emplace_back(fd, generation);
+    }
+    // 列表非空说明已有人唤醒过且循环还没取走 不必重复写eventfd
+    if (first) wakeup();
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t n = ::write(wakeup_fd_, &one, sizeof(one));
+    if (n != sizeof(one) && errno != EAGAIN) {
+        std::cerr << "Failed to wake up event loop " << index_ << ": " << strerror(errno) << std::endl;
+    }
+}
+
+void EventLoop::handleWakeup() {
+    uint64_t count;
+    ::read(wakeup_fd_, &count, sizeof(count));
+
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        flushing_.swap(pending_flush_);
+    }
+    if (flush_handler_) {
+        for (auto [fd, generation] : flushing_) {
+            flush_handler_(*this, fd, generation);
+        }
+    }
+    flushing_.clear();
+}
+
+void EventLoop::join() {
+    if (thread_.joinable() && !isInLoopThread()) {
+        thread_.join();
+    }
+}
@@ -0,0 +1,201 @@
+#include "net/TimerWheel.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <climits>
+
+TimerWheel::TimerWheel(uint32_t tickMs) : tick_ms_(std::max<uint32_t>(1, tickMs)), start_ms_(nowMs()) {
+    levels_[0].heads.assign(ROOT_SIZE, NIL);
+    for (int i = 1; i < LEVELS; ++i) {
+        levels_[i].heads.assign(LEVEL_SIZE, NIL);
+    }
+}
+
+uint64_t TimerWheel::nowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t delayMs, Callback cb) {
+    uint64_t now = nowMs();
+    // 向上取整到tick 且至少落在下一个未处理的tick上
+    uint64_t expires = (now + delayMs - start_ms_ + tick_ms_ - 1) / tick_ms_;
+    expires = std::max(expires, current_);
+
+    uint32_t index = allocNode();
+    Node& node = nodes_[index];
+    node.callback = std::move(cb);
+    node.expires = expires;
+    node.active = true;
+    link(index);
+    ++count_;
+    return makeId(index);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (id == INVALID_TIMER) return false;
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= nodes_.size()) return false;
+
+    Node& node = nodes_[index];
+    if (!node.active || node.generation != generation) return false;
+    unlink(index);
+    freeNode(index);
+    --count_;
+    return true;
+}
+
+size_t TimerWheel::advance(uint64_t nowMs) {
+    if (nowMs < start_ms_) return 0;
+    uint64_t target = tickOf(nowMs);
+    size_t executed = 0;
+
+    while (current_ <= target) {
+        if (count_ == 0) {
+            // 没有定时器 直接跳到目标tick 避免长时间阻塞后逐tick空转
+            current_ = target + 1;
+            break;
+        }
+
+        uint32_t slot = static_cast<uint32_t>(current_ & (ROOT_SIZE - 1));
+        if (slot == 0) {
+            // 第0层转完一圈 把上层对应槽中的定时器降级 上一层也转完一圈时继续向上
+            for (int level = 1; level < LEVELS; ++level) {
+                uint32_t upper = static_cast<uint32_t>((current_ >> (ROOT_BITS + (level - 1) * LEVEL_BITS)) & (LEVEL_SIZE - 1));
+                cascade(level, upper);
+                if (upper != 0) break;
+            }
+        }
+
+        // 先摘下整个槽再执行 回调中新建的定时器至少落在下一个tick
+        expired_.clear();
+        for (uint32_t index = levels_[0].heads[slot]; index != NIL; index = nodes_[index].next) {
+            nodes_[index].level = DETACHED;
+            expired_.push_back(makeId(index));
+        }
+        levels_[0].heads[slot] = NIL;
+        levels_[0].occupied[slot / 64] &= ~(1ull << (slot % 64));
+        ++current_;
+
+        for (TimerId id : expired_) {
+            // 前面的回调可能已经取消了它 节点也可能已被复用 用generation区分
+            uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+            if (!nodes_[index].active || makeId(index) != id) continue;
+            Callback cb = std::move(nodes_[index].callback);
+            freeNode(index);
+            --count_;
+            cb();
+            ++executed;
+        }
+    }
+    return executed;
+}
+
+int TimerWheel::nextTimeoutMs(uint64_t nowMs, int maxMs) const {
+    if (count_ == 0) return maxMs;
+
+    // 在第0层位图中找从current_开始的第一个非空槽 找不到时至少要在第0层转完一圈时醒来做降级
+    // current_正好在圈首时 降级就发生在处理current_的时候
+    uint64_t ticks = (ROOT_SIZE - (current_ & (ROOT_SIZE - 1))) & (ROOT_SIZE - 1);
+    uint32_t start = static_cast<uint32_t>(current_ & (ROOT_SIZE - 1));
+    const auto& bits = levels_[0].occupied;
+    for (uint32_t offset = 0; offset < ROOT_SIZE; ) {
+        uint32_t slot = (start + offset) & (ROOT_SIZE - 1);
+        uint64_t word = bits[slot / 64] >> (slot % 64);
+        if (word != 0) {
+            uint32_t found = offset + static_cast<uint32_t>(std::countr_zero(word));
+            ticks = std::min<uint64_t>(ticks, found);
+            break;
+        }
+        offset += 64 - slot % 64;
+    }
+
+    uint64_t dueMs = start_ms_ + (current_ + ticks) * tick_ms_;
+    if (dueMs <= nowMs) return 0;
+    // maxMs为负表示调用方原本无限等待
+    uint64_t limit = maxMs < 0 ? static_cast<uint64_t>(INT_MAX) : static_cast<uint64_t>(maxMs);
+    return static_cast<int>(std::min(dueMs - nowMs, limit));
+}
+
+uint32_t TimerWheel::allocNode() {
+    if (free_head_ != NIL) {
+        uint32_t index = free_head_;
+        free_head_ = nodes_[index].next;
+        nodes_[index].next = NIL;
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimerWheel::freeNode(uint32_t index) {
+    Node& node = nodes_[index];
+    node.callback = nullptr;
+    node.active = false;
+    ++node.generation;
+    if (node.generation == 0) node.generation = 1;
+    node.prev = NIL;
+    node.next = free_head_;
+    free_head_ = index;
+}
+
+void TimerWheel::link(uint32_t index) {
+    Node& node = nodes_[index];
+    uint64_t delta = std::min(node.expires - current_, MAX_TICKS - 1);
+    uint64_t expires = current_ + delta;
+
+    int level;
+    uint32_t slot;
+    if (delta < ROOT_SIZE) {
+        level = 0;
+        slot = static_cast<uint32_t>(expires & (ROOT_SIZE - 1));
+    } else {
+        level = 1;
+        while (level < LEVELS - 1 && delta >= (1ull << (ROOT_BITS + level * LEVEL_BITS))) {
+            ++level;
+        }
+        slot = static_cast<uint32_t>((expires >> (ROOT_BITS + (level - 1) * LEVEL_BITS)) & (LEVEL_SIZE - 1));
+    }
+
+    Level& wheel = levels_[level];
+    node.level = static_cast<uint8_t>(level);
+    node.slot = static_cast<uint16_t>(slot);
+    node.prev = NIL;
+    node.next = wheel.heads[slot];
+    if (node.next != NIL) nodes_[node.next].prev = index;
+    wheel.heads[slot] = index;
+    wheel.occupied[slot / 64] |= 1ull << (slot % 64);
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.level == DETACHED) {
+        // 已从槽中摘下 正等待本轮advance执行
+        node.prev = node.next = NIL;
+        return;
+    }
+    Level& wheel = levels_[node.level];
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        wheel.heads[node.slot] = node.next;
+        if (node.next == NIL) {
+            wheel.occupied[node.slot / 64] &= ~(1ull << (node.slot % 64));
+        }
+    }
+    if (node.next != NIL) nodes_[node.next].prev = node.prev;
+    node.prev = node.next = NIL;
+}
+
+void TimerWheel::cascade(int level, uint32_t slot) {
+    Level& wheel = levels_[level];
+    uint32_t index = wheel.heads[slot];
+    wheel.heads[slot] = NIL;
+    wheel.occupied[slot / 64] &= ~(1ull << (slot % 64));
+    while (index != NIL) {
+        uint32_t next = nodes_[index].next;
+        link(index);
+        index = next;
+    }
+}
@@ -0,0 +1,102 @@
+#include "net/WriteQueue.h"
+#include <climits>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+void WriteQueue::push(SharedFrame frame) {
+    if (!frame || frame->empty()) return;
+    bytes_ += frame->size();
+    frames_.push_back(std::move(frame));
+}
+
+void WriteQueue::clear() {
+    frames_.clear();
+    head_offset_ = 0;
+    bytes_ = 0;
+}
+
+FlushResult WriteQueue::flush(int fd) {
+    FlushResult result{0, 0, false, false};
+    iovec iov[IOV_MAX];
+
+    while (!frames_.empty()) {
+        int iovcnt = 0;
+        size_t offset = head_offset_;
+        for (const auto& frame : frames_) {
+            if (iovcnt == IOV_MAX) break;
+            iov[iovcnt].iov_base = const_cast<char*>(frame->data()) + offset;
+            iov[iovcnt].iov_len = frame->size() - offset;
+            offset = 0;
+            ++iovcnt;
+        }
+
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        ++result.syscalls;
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                result.would_block = true;
+            } else {
+                result.error = true;
+            }
+            break;
+        }
+
+        if (n == 0) break;
+        result.bytes_sent += n;
+        consume(n);
+    }
+    return result;
+}
+
+void WriteQueue::consume(size_t len) {
+    bytes_ -= len;
+    while (len > 0) {
+        size_t remaining = frames_.front()->size() - head_offset_;
+        if (len < remaining) {
+            head_offset_ += len;
+            return;
+        }
+        len -= remaining;
+        frames_.pop_front();
+        head_offset_ = 0;
+    }
+}
+
+DropResult WriteQueue::dropOldest(const std::function<bool(uint16_t)>& droppable, size_t targetBytes) {
+    DropResult result;
+    if (frames_.empty()) return result;
+
+    std::deque<SharedFrame> kept;
+    auto it = frames_.begin();
+    if (head_offset_ > 0) {
+        kept.push_back(std::move(*it));
+        ++it;
+    }
+    for (; it != frames_.end(); ++it) {
+        bool reached = targetBytes > 0 && bytes_ <= targetBytes;
+        if (!reached && droppable(frameType(**it))) {
+            bytes_ -= (*it)->size();
+            result.bytes += (*it)->size();
+            ++result.frames;
+            continue;
+        }
+        kept.push_back(std::move(*it));
+    }
+    frames_.swap(kept);
+    return result;
+}
+
+uint16_t WriteQueue::frameType(const std::string& frame) {
+    if (frame.size() < 2) return 0;
+    return static_cast<uint16_t>((static_cast<uint8_t>(frame[0]) << 8) | static_cast<uint8_t>(frame[1]));
+}
@@ -5,47 +5,172 @@
 #include <iostream>
 #include <unistd.h>
 #include <algorithm>
+#include <limits>
 #include <fcntl.h>
 #include <netinet/tcp.h>
 #include "utils/EnvLoader.h"
+#include "utils/ThreadPool.h"
+#include "utils/WorkStealingPool.h"
 #include "utils/TimeUtils.h"
+#include "utils/CpuAffinity.h"
 #include <random>
 #include <chrono>
 
-ChatRoomServer::ChatRoomServer()
-    : listen_fd_(-1)
-{
+namespace {
+
+std::unique_ptr<Executor> makeExecutor(const std::string& type, size_t threadCount, Executor::ThreadInit init) {
+    if (type == "work_stealing") {
+        return std::make_unique<WorkStealingPool>(threadCount, std::move(init));
+    }
+    if (type != "mutex") {
+        std::cerr << "Unknown THREAD_POOL_TYPE '" << type << "', using mutex" << std::endl;
+    }
+    return std::make_unique<ThreadPool>(threadCount, std::move(init));
+}
+
+// 未设置返回空列表(不绑核) 格式错误时报错并忽略
+std::vector<int> loadCpuList(const std::string& name) {
+    auto spec = EnvLoader::getString(name);
+    if (!spec || spec->empty()) return {};
+    auto cpus = CpuAffinity::parseCpuList(*spec);
+    if (!cpus) {
+        std::cerr << "Invalid " << name << " '" << *spec << "', thread placement left to the kernel" << std::endl;
+        return {};
+    }
+    return *cpus;
+}
+
+// 绑核并打印实际放置 整行拼好再输出 避免多线程日志交错
+void pinThread(const std::string& label, const std::vector<int>& cpus) {
+    if (cpus.empty()) return;
+    if (!CpuAffinity::pinCurrentThread(cpus)) {
+        std::cerr << "[affinity] " << label << ": failed to pin to cpus " << CpuAffinity::formatCpuList(cpus) << std::endl;
+        return;
+    }
+    std::cout << ("[affinity] " + label + ": " + CpuAffinity::describeCurrentThread() + "\n") << std::flush;
+}
+
+// 回复和踢下线/系统通知必须送达 聊天和进出房间推送可以丢弃 房间属性推送只需最新一条
+FrameClass classifyFrame(uint16_t type) {
+    switch (type) {
+        case MSG_CHAT_MESSAGE_PUSH:
+        case MSG_USER_JOIN_PUSH:
+        case MSG_USER_LEAVE_PUSH:
+            return FrameClass::Droppable;
+        case MSG_ROOM_NAME_UPDATE_PUSH:
+        case MSG_ROOM_DESCRIPTION_UPDATE_PUSH:
+        case MSG_ROOM_MAX_USERS_UPDATE_PUSH:
+            return FrameClass::Coalescable;
+        default:
+            return FrameClass::Essential;
+    }
+}
+
+Json::Value histogramToJson(const HistogramSnapshot& snap) {
+    Json::Value json;
+    json["count"] = Json::UInt64(snap.count);
+    json["sum"] = Json::UInt64(snap.sum);
+    json["max"] = Json::UInt64(snap.max);
+    json["p50"] = Json::UInt64(snap.p50);
+    json["p90"] = Json::UInt64(snap.p90);
+    json["p99"] = Json::UInt64(snap.p99);
+    json["p999"] = Json::UInt64(snap.p999);
+    return json;
+}
+
+Json::Value executorToJson(const ExecutorStats& stats) {
+    Json::Value json;
+    json["type"] = stats.type;
+    json["threads"] = Json::UInt64(stats.threads);
+    json["workers"] = Json::Value(Json::arrayValue);
+    for (const auto& worker : stats.workers) {
+        Json::Value w;
+        w["tasks"] = Json::UInt64(worker.tasks);
+        w["busy_us"] = Json::UInt64(worker.busy_us);
+        w["idle_us"] = Json::UInt64(worker.idle_us);
+        json["workers"].append(w);
+    }
+    json["queue_wait_us"] = histogramToJson(stats.queue_wait_us);
+    json["run_us"] = histogramToJson(stats.run_us);
+    json["queue_depth"] = histogramToJson(stats.queue_depth);
+    return json;
+}
+
+Json::Value laneToJson(const LaneStats& stats) {
+    Json::Value json;
+    json["name"] = stats.name;
+    json["queue_limit"] = Json::UInt64(stats.queue_limit);
+    json["pending"] = Json::UInt64(stats.pending);
+    json["peak_pending"] = Json::UInt64(stats.peak_pending);
+    json["submitted"] = Json::UInt64(stats.submitted);
+    json["rejected"] = Json::UInt64(stats.rejected);
+    json["completed"] = Json::UInt64(stats.completed);
+    json["wait_us"] = Json::UInt64(stats.wait_us);
+    json["run_us"] = Json::UInt64(stats.run_us);
+    json["pool"] = executorToJson(stats.pool);
+    return json;
+}
+
+}
+
+ChatRoomServer::ChatRoomServer() {
     port_ = static_cast<uint16_t>(EnvLoader::getInt("SERVER_PORT").value_or(8080));
-    size_t threadCount = EnvLoader::getInt("THREAD_POOL_SIZE").value_or(std::thread::hardware_concurrency());
+    reactor_count_ = std::max(1, EnvLoader::getInt("REACTOR_COUNT").value_or(1));
     epoll_timeout_ms_ = EnvLoader::getInt("EPOLL_TIMEOUT_MS").value_or(1000);
     max_read_buffer_size_ = EnvLoader::getInt("MAX_READ_BUFFER_SIZE").value_or(1024 * 1024);
     max_write_buffer_size_ = EnvLoader::getInt("MAX_WRITE_BUFFER_SIZE").value_or(1024 * 1024);
     token_expire_minutes_ = EnvLoader::getInt("TOKEN_EXPIRE_MINUTES").value_or(30);
-    cleanup_interval_minutes_ = EnvLoader::getInt("CLEANUP_INTERVAL_MINUTES").value_or(10);
-    thread_pool_ = std::make_unique<ThreadPool>(threadCount);
+    token_expiry_tick_ms_ = static_cast<uint64_t>(std::max(10, EnvLoader::getInt("TOKEN_EXPIRY_TICK_MS").value_or(1000)));
+    token_expiry_batch_ = static_cast<size_t>(std::max(1, EnvLoader::getInt("TOKEN_EXPIRY_BATCH").value_or(1024)));
+    edge_triggered_ = EnvLoader::getBool("EPOLL_EDGE_TRIGGERED").value_or(false);
+    read_budget_bytes_ = std::max(4096, EnvLoader::getInt("READ_BUDGET_BYTES").value_or(64 * 1024));
+    client_events_ = EPOLLIN | (edge_triggered_ ? static_cast<uint32_t>(EPOLLET) : 0u);
+    heartbeat_interval_ms_ = static_cast<uint64_t>(std::max(0, EnvLoader::getInt("HEARTBEAT_INTERVAL_SECONDS").value_or(30))) * 1000;
+    heartbeat_timeout_ms_ = static_cast<uint64_t>(std::max(1, EnvLoader::getInt("HEARTBEAT_TIMEOUT_SECONDS").value_or(10))) * 1000;
+    close_drain_timeout_ms_ = static_cast<uint64_t>(std::max(0, EnvLoader::getInt("CLOSE_DRAIN_TIMEOUT_MS").value_or(1000)));
+
+    BackpressureConfig backpressure;
+    backpressure.high_watermark = EnvLoader::getInt("WRITE_HIGH_WATERMARK").value_or(256 * 1024);
+    backpressure.low_watermark = EnvLoader::getInt("WRITE_LOW_WATERMARK").value_or(64 * 1024);
+    backpressure.hard_limit = max_write_buffer_size_;
+    backpressure.memory_budget = static_cast<size_t>(EnvLoader::getInt("WRITE_MEMORY_BUDGET_MB").value_or(256)) * 1024 * 1024;
+    std::string policy = EnvLoader::getString("BACKPRESSURE_POLICY").value_or("drop_oldest");
+    if (auto parsed = BackpressureController::parsePolicy(policy)) {
+        backpressure.policy = *parsed;
+    } else {
+        std::cerr << "Unknown BACKPRESSURE_POLICY '" << policy << "', using drop_oldest" << std::endl;
+    }
+    backpressure.classify = classifyFrame;
+    Json::Value notice;
+    notice["message"] = "Connection closed: too many undelivered messages";
+    backpressure.disconnect_notice = Connection::encodeFrame(MSG_SYSTEM_MESSAGE_PUSH, notice.toStyledString());
+    backpressure_ = std::make_unique<BackpressureController>(std::move(backpressure));
+
+    token_signer_ = std::make_unique<TokenSigner>(EnvLoader::getString("TOKEN_SECRET").value_or(""));
 
+    // 绑核: 每个reactor独占列表中的一个CPU(按序号轮转) 工作线程在CPU集合内由内核调度
+    // 连接的缓冲区在所属reactor线程上分配和首次写入 reactor绑核后按first-touch落在该CPU所在的NUMA节点
+    reactor_cpus_ = loadCpuList("REACTOR_CPUS");
+    worker_cpus_ = loadCpuList("WORKER_CPUS");
+
+    setupExecutors();
     setupServer();
     setupServices();
+    setupMessagePersistence();
     loadRoomsFromDatabase();
-
-    cleanup_thread_ = std::thread([this]() {
-        while (cleanup_running_) {
-            std::this_thread::sleep_for(std::chrono::minutes(cleanup_interval_minutes_));
-            if (cleanup_running_) cleanupExpiredTokens();
-        }
-    });
 }
 
 ChatRoomServer::~ChatRoomServer() {
     stop();
 
-    cleanup_running_ = false;
-    if (cleanup_thread_.joinable()) cleanup_thread_.join();
+    // 先写完排队的消息 再停数据库I/O线程 再停业务通道 它们可能还会向控制通道投递清理任务
+    message_batcher_->stop();
+    async_db_->stop();
+    cpu_lane_->stop();
+    db_lane_->stop();
+    control_lane_->stop();
 
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        connections_.clear();
-    }
+    connections_.clear();
 
     {
         std::lock_guard<std::mutex> lock(active_rooms_mutex_);
@@ -67,71 +192,204 @@ ChatRoomServer::~ChatRoomServer() {
         std::lock_guard<std::mutex> lock(userId_to_roomId_mutex_);
         userId_to_roomId_.clear();
     }
-    {
-        std::lock_guard<std::mutex> lock(userId_to_token_mutex_);
-        userId_to_token_.clear();
-    }
 
-    if (listen_fd_ >= 0) {
-        close(listen_fd_);
-    }
+    loops_.clear();
 }
 
 void ChatRoomServer::run() {
     running_ = true;
-    std::cout << "ChatRoom server listening on port " << port_ << std::endl;
-    
-    while (running_) {
-        auto events = poller_.poll(epoll_timeout_ms_); 
-        for (auto& ev : events) {
-            handleEvent(ev);
+    std::cout << "ChatRoom server listening on port " << port_
+              << " with " << loops_.size() << " event loop(s) on "
+              << loops_[0]->getPoller().name() << std::endl;
+
+    auto handler = [this](EventLoop& loop, const epoll_event& ev) {
+        handleEvent(loop, ev);
+    };
+    for (auto& loop : loops_) {
+        loop->setFlushHandler([this](EventLoop& loop, int fd, uint32_t generation) {
+            handleFlush(loop, fd, generation);
+        });
+        if (!reactor_cpus_.empty()) {
+            int index = loop->getIndex();
+            int cpu = reactor_cpus_[index % reactor_cpus_.size()];
+            loop->setThreadInit([index, cpu]() {
+                pinThread("reactor " + std::to_string(index), {cpu});
+            });
         }
     }
+
+    // 0号循环运行在调用线程上 循环开始前在这里注册定时器是安全的
+    scheduleTokenExpiry(*loops_[0]);
+
+    // 0号循环运行在调用线程上 其余循环各自一个线程
+    for (size_t i = 1; i < loops_.size(); ++i) {
+        loops_[i]->start(handler);
+    }
+    loops_[0]->run(handler);
+
+    for (auto& loop : loops_) {
+        loop->stop();
+        loop->join();
+    }
 }
 
 void ChatRoomServer::stop() {
     running_ = false;
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
     std::cout << "Server stopping..." << std::endl;
 }
 
 void ChatRoomServer::setupServer() {
-    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (listen_fd_ < 0) {
+    bool reusePort = reactor_count_ > 1;
+    for (int i = 0; i < reactor_count_; ++i) {
+        int listenFd = createListenSocket(reusePort);
+        loops_.push_back(std::make_unique<EventLoop>(i, listenFd, epoll_timeout_ms_));
+    }
+}
+
+void ChatRoomServer::setupExecutors() {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::string poolType = EnvLoader::getString("THREAD_POOL_TYPE").value_or("mutex");
+    // THREAD_POOL_SIZE保留原含义: 处理普通请求(大多要访问数据库)的线程数
+    size_t dbThreads = EnvLoader::getInt("DB_POOL_SIZE").value_or(EnvLoader::getInt("THREAD_POOL_SIZE").value_or(cores));
+    size_t cpuThreads = EnvLoader::getInt("CPU_POOL_SIZE").value_or(cores);
+    size_t controlThreads = EnvLoader::getInt("CONTROL_POOL_SIZE").value_or(2);
+
+    auto pinWorker = [this](const std::string& lane) -> Executor::ThreadInit {
+        if (worker_cpus_.empty()) return nullptr;
+        return [this, lane](size_t index) {
+            pinThread(lane + " worker " + std::to_string(index), worker_cpus_);
+        };
+    };
+    control_lane_ = std::make_unique<ExecutorLane>("control",
+        makeExecutor(poolType, std::max<size_t>(1, controlThreads), pinWorker("control")),
+        EnvLoader::getInt("CONTROL_QUEUE_LIMIT").value_or(10000));
+    db_lane_ = std::make_unique<ExecutorLane>("db",
+        makeExecutor(poolType, std::max<size_t>(1, dbThreads), pinWorker("db")),
+        EnvLoader::getInt("DB_QUEUE_LIMIT").value_or(2000));
+    cpu_lane_ = std::make_unique<ExecutorLane>("cpu",
+        makeExecutor(poolType, std::max<size_t>(1, cpuThreads), pinWorker("cpu")),
+        EnvLoader::getInt("CPU_QUEUE_LIMIT").value_or(256));
+    // 数据库I/O线程只阻塞在MySQL调用上 数量与连接池上限一致即可让连接池跑满
+    size_t dbIoThreads = EnvLoader::getInt("DB_IO_THREADS").value_or(EnvLoader::getInt("DB_POOL_MAX").value_or(16));
+    async_db_ = std::make_unique<AsyncDb>(std::make_unique<ThreadPool>(std::max<size_t>(1, dbIoThreads), pinWorker("db io")));
+
+    // 路由表 未列出的消息类型走控制通道
+    for (uint16_t type : {MSG_LOGOUT, MSG_FETCH_ACTIVE_ROOMS, MSG_FETCH_INACTIVE_ROOMS, MSG_JOIN_ROOM, MSG_LEAVE_ROOM,
+                          MSG_FETCH_SERVER_STATS}) {
+        message_lanes_[type] = control_lane_.get();
+    }
+    for (uint16_t type : {MSG_CHANGE_DISPLAY_NAME, MSG_CREATE_ROOM, MSG_DELETE_ROOM, MSG_SET_ROOM_NAME,
+                          MSG_SET_ROOM_DESCRIPTION, MSG_SET_ROOM_MAX_USERS, MSG_SET_ROOM_STATUS,
+                          MSG_SEND_MESSAGE, MSG_GET_MESSAGE_HISTORY, MSG_GET_USER_INFO}) {
+        message_lanes_[type] = db_lane_.get();
+    }
+    // 注册/登录/改密码的主要开销在密码哈希上
+    // 登录中途要等数据库 handleLogin在校验密码前会显式切回cpu通道 不依赖恢复到哪个执行器
+    for (uint16_t type : {MSG_REGISTER, MSG_CHANGE_PASSWORD, MSG_LOGIN}) {
+        message_lanes_[type] = cpu_lane_.get();
+    }
+    for (uint16_t type = MSG_REGISTER; type <= MSG_FETCH_SERVER_STATS; ++type) {
+        request_metrics_[type] = std::make_unique<RequestMetrics>();
+    }
+
+    std::cout << "Executor lanes (" << poolType << "): control=" << control_lane_->executor().threadCount()
+              << " db=" << db_lane_->executor().threadCount()
+              << " cpu=" << cpu_lane_->executor().threadCount() << " threads, db io="
+              << async_db_->getStats().threads << " threads" << std::endl;
+}
+
+ExecutorLane& ChatRoomServer::laneFor(uint16_t messageType) {
+    auto it = message_lanes_.find(messageType);
+    return it != message_lanes_.end() ? *it->second : *control_lane_;
+}
+
+int ChatRoomServer::createListenSocket(bool reusePort) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
         throw std::runtime_error("socket creation failed: " + std::string(strerror(errno)));
     }
     
     int opt = 1;
-    if (setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        close(listen_fd_);
+    if (setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        close(listenFd);
         throw std::runtime_error("setsockopt failed: " + std::string(strerror(errno)));
     }
+
+    if (reusePort && !setReusePort(listenFd)) {
+        close(listenFd);
+        throw std::runtime_error("setsockopt SO_REUSEPORT failed: " + std::string(strerror(errno)));
+    }
     
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
     addr.sin_port = htons(port_);
     
-    if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(listen_fd_);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(listenFd);
         throw std::runtime_error("bind failed: " + std::string(strerror(errno)));
     }
     
-    if (listen(listen_fd_, SOMAXCONN) < 0) {
-        close(listen_fd_);
+    if (listen(listenFd, SOMAXCONN) < 0) {
+        close(listenFd);
         throw std::runtime_error("listen failed: " + std::string(strerror(errno)));
     }
     
-    if (!setNonBlocking(listen_fd_)) {
+    if (!setNonBlocking(listenFd)) {
         std::cerr << "Failed to set non-blocking mode for listen fd" << std::endl;
-        return;
     }
-    poller_.addFd(listen_fd_, EPOLLIN | EPOLLET);
+    return listenFd;
 }
 
 void ChatRoomServer::setupServices() {
     service_manager_ = std::make_shared<ServiceManager>();
 }
 
+void ChatRoomServer::setupMessagePersistence() {
+    // room_seq在本进程内存中分配 两个实例同时写同一个库会发出重复的序号 拿不到写入者锁就不启动
+    auto writerLock = service_manager_->acquireMessageWriterLock();
+    if (!writerLock.ok) {
+        throw std::runtime_error("failed to acquire message writer lock: " + writerLock.message);
+    }
+    if (!writerLock.data) {
+        throw std::runtime_error("another server instance is already writing messages to this database");
+    }
+    message_ids_ = std::make_unique<SnowflakeId>(EnvLoader::getInt("NODE_ID").value_or(0));
+    // 库中已有的id和序号决定起点 查不到就不启动 否则可能生成重复的id或序号
+    auto maxId = service_manager_->getMaxMessageId();
+    if (!maxId.ok) {
+        throw std::runtime_error("failed to load max message id: " + maxId.message);
+    }
+    message_ids_->observe(maxId.data);
+    auto sequences = service_manager_->getRoomSequences();
+    if (!sequences.ok) {
+        throw std::runtime_error("failed to load room sequences: " + sequences.message);
+    }
+    for (const auto& [roomId, lastSeq] : sequences.data) {
+        room_sequences_.seed(roomId, lastSeq);
+    }
+
+    MessageBatcherConfig config;
+    config.batch_size = static_cast<size_t>(std::max(1, EnvLoader::getInt("MESSAGE_BATCH_SIZE").value_or(256)));
+    config.flush_interval_ms = std::max(0, EnvLoader::getInt("MESSAGE_FLUSH_INTERVAL_MS").value_or(20));
+    config.max_pending = static_cast<size_t>(std::max(1, EnvLoader::getInt("MESSAGE_QUEUE_LIMIT").value_or(100000)));
+    config.max_retries = std::max(0, EnvLoader::getInt("MESSAGE_MAX_RETRIES").value_or(5));
+    auto serviceManager = service_manager_;
+    message_batcher_ = std::make_unique<MessageBatcher>(
+        [serviceManager](const std::vector<Message>& messages) {
+            auto result = serviceManager->saveMessages(messages);
+            if (!result.ok) std::cerr << "Failed to save messages: " << result.message << std::endl;
+            return result.ok;
+        },
+        config);
+
+    room_history_ = std::make_unique<RoomHistoryCache>(
+        static_cast<size_t>(std::max(1, EnvLoader::getInt("ROOM_HISTORY_SIZE").value_or(200))));
+}
+
 void ChatRoomServer::loadRoomsFromDatabase() {
     auto result = service_manager_->getAllRooms();
     if (result.ok) {
@@ -151,30 +409,38 @@ void ChatRoomServer::loadRoomsFromDatabase() {
     }
 }
 
-void ChatRoomServer::handleEvent(const epoll_event& ev) {
-    int fd = ev.data.fd;
+void ChatRoomServer::handleEvent(EventLoop& loop, const epoll_event& ev) {
+    int fd = Poller::eventFd(ev);
+    // 连接注册时把generation放在事件数据里 fd被复用后旧注册残留的事件凭它识别
+    uint32_t generation = Poller::eventTag(ev);
     
-    if (fd == listen_fd_) {
-        handleNewConnection();
+    if (fd == loop.getListenFd()) {
+        handleNewConnection(loop);
     } else {
         if (ev.events & EPOLLIN) {
-            handleReadEvent(fd);
+            handleReadEvent(loop, fd, generation);
         }
         if (ev.events & EPOLLOUT) {
-            handleWriteEvent(fd);
+            handleWriteEvent(loop, fd, generation);
         }
         if (ev.events & (EPOLLERR | EPOLLHUP)) {
-            handleConnectionError(fd);
+            handleConnectionError(fd, generation);
         }
     }
 }
 
-void ChatRoomServer::handleNewConnection() {
+std::shared_ptr<Connection> ChatRoomServer::loopConnection(EventLoop& loop, int fd, uint32_t generation) const {
+    auto connection = connections_.get(fd, generation);
+    if (!connection || connection->getLoopIndex() != loop.getIndex()) return nullptr;
+    return connection;
+}
+
+void ChatRoomServer::handleNewConnection(EventLoop& loop) {
     while (true) {
         struct sockaddr_in client_addr;
         socklen_t client_addr_len = sizeof(client_addr);
         
-        int client_fd = accept(listen_fd_, (struct sockaddr*)&client_addr, &client_addr_len);
+        int client_fd = accept(loop.getListenFd(), (struct sockaddr*)&client_addr, &client_addr_len);
         if (client_fd < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 break;
@@ -202,103 +468,250 @@ void ChatRoomServer::handleNewConnection() {
             std::cerr << "Failed to set TCP_NODELAY: " << strerror(errno) << std::endl;
         }
         
-        auto connection = std::make_shared<Connection>(client_fd);
+        auto connection = std::make_shared<Connection>(client_fd, loop.getIndex());
+        connection->setStrand(std::make_shared<Strand>(control_lane_->executor()));
         
-        connection->setWriteEventCallback([this](int fd) {
-            poller_.modifyFd(fd, EPOLLIN | EPOLLOUT);
+        // 工作线程发送时只把fd交给所属循环 由循环线程直接写 写不完才注册EPOLLOUT
+        EventLoop* owner = &loop;
+        connection->setWriteEventCallback([owner](int fd, uint32_t generation) {
+            owner->queueFlush(fd, generation);
         });
+        connection->setBackpressure(backpressure_.get());
         
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            connections_[client_fd] = connection;
+        if (!connections_.insert(client_fd, connection)) {
+            std::cerr << "Connection fd " << client_fd << " exceeds table capacity "
+                      << connections_.capacity() << ", closing it" << std::endl;
+            ::close(client_fd);
+            continue;
         }
         
-        if (!poller_.addFd(client_fd, EPOLLIN)) {
+        if (!loop.getPoller().addFd(client_fd, client_events_, connection->getGeneration())) {
             std::cerr << "Failed to add client fd to epoll: " << strerror(errno) << std::endl;
+            connections_.remove(client_fd, connection->getGeneration());
             ::close(client_fd);
-            {
-                std::lock_guard<std::mutex> lock(connections_mutex_);
-                connections_.erase(client_fd);
-            }
             continue;
         }
+
+        if (heartbeat_interval_ms_ > 0) {
+            scheduleHeartbeat(loop, connection, heartbeat_interval_ms_);
+        }
     }
 }
 
-void ChatRoomServer::handleReadEvent(int fd) {
-    Connection* connection = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = connections_.find(fd);
-        if (it == connections_.end()) {
-            thread_pool_->addTask([this, fd]() {
-                cleanupConnection(fd);
-            });
+void ChatRoomServer::handleReadEvent(EventLoop& loop, int fd, uint32_t generation) {
+    // 已经清理过(关闭fd的是清理方)或事件属于fd上一代的连接 什么都不做
+    auto connection = loopConnection(loop, fd, generation);
+    if (!connection) return;
+    // 关闭中的连接不再处理请求 改为只等可写
+    if (connection->isClosing()) {
+        closeWhenDrained(loop, *connection, fd, generation, false);
+        return;
+    }
+    
+    // 循环读取直到读空(短读或EAGAIN) 单次事件最多读read_budget_bytes_ 防止一个连接饿死同一循环里的其他连接
+    size_t total = 0;
+    size_t lastRead = 0;
+    bool drained = false;
+    while (total < static_cast<size_t>(read_budget_bytes_)) {
+        size_t want = connection->getReadSize();
+        auto result = connection->recvToReadBuffer(fd, want);
+        
+        if (result.error) {
+            handleConnectionError(fd, generation);
+            return;
+        } else if (result.connection_closed) {
+            cleanupConnection(fd, generation);
             return;
         }
-        connection = it->second.get();
+        
+        lastRead = static_cast<size_t>(result.bytes_read);
+        total += lastRead;
+        // 短读说明内核缓冲区已经读空 不必再多一次返回EAGAIN的recv
+        if (lastRead < want) {
+            drained = true;
+            break;
+        }
+        connection->adaptReadSize(lastRead, total);
     }
+    if (drained) connection->adaptReadSize(lastRead, total);
     
-    auto result = connection->recvToReadBuffer(fd, 4096);
+    // 边缘触发下预算用完但可能还有数据 不会再有新的通知 交给事件循环下一轮继续读
+    // 水平触发下poller自己会再次报告 不需要处理
+    if (!drained && edge_triggered_) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = Poller::packData(fd, generation);
+        loop.deferEvent(ev);
+    }
+
+    if (total == 0) return;
+    connection->touch(TimerWheel::nowMs());
+    auto messages = connection->extractMessages();
+    uint64_t received = PoolMetrics::nowUs();
+    for (const auto& msg : messages) {
+        // 心跳消息直接在循环线程处理 不进线程池 收到任何数据都已算作活跃
+        if (msg.type == MSG_PING) {
+            connection->sendMessage(MSG_PONG, "{}");
+            continue;
+        }
+        if (msg.type == MSG_PONG) {
+            continue;
+        }
+        // 按消息类型选择执行通道 通道排队已满时直接回复繁忙 不让请求无限堆积
+        ExecutorLane& lane = laneFor(msg.type);
+        if (!lane.tryAcquire()) {
+            sendErrorResponse(fd, static_cast<uint16_t>(msg.type + 1000), "服务器繁忙, 请稍后再试",
+                              ErrorCode::SERVICE_UNAVAILABLE);
+            continue;
+        }
+        // 同一连接的请求在它的Strand上串行执行 不同连接之间并行
+        // 处理函数是协程 挂起等待数据库时Strand保持占用 直到协程结束才处理该连接的下一条请求
+        auto strand = connection->getStrand();
+        auto metricsIt = request_metrics_.find(msg.type);
+        RequestMetrics* metrics = metricsIt != request_metrics_.end() ? metricsIt->second.get() : nullptr;
+        auto job = [this, fd, generation, msg, strand, metrics, received]() {
+            uint64_t start = PoolMetrics::nowUs();
+            if (metrics) metrics->wait_us.record(start > received ? start - received : 0);
+            handleRequest(fd, generation, msg).start([strand, metrics, start]() {
+                if (metrics) metrics->run_us.record(PoolMetrics::nowUs() - start);
+                strand->complete();
+            });
+        };
+        // 每条请求都走这里 闭包放不进Task内部就会每条请求分配一次堆内存
+        static_assert(sizeof(job) <= Task::INLINE_SIZE, "request closure no longer fits in Task inline storage");
+        strand->postAsync(std::move(job), lane);
+    }
+}
+
+void ChatRoomServer::handleWriteEvent(EventLoop& loop, int fd, uint32_t generation) {
+    auto connection = loopConnection(loop, fd, generation);
+    if (!connection) return;
+
+    auto result = connection->sendFromWriteBuffer(fd);
     
     if (result.error) {
-        handleConnectionError(fd);
+        handleConnectionError(fd, generation);
         return;
-    } else if (result.connection_closed) {
-        cleanupConnection(fd);
+    }
+    if (connection->isClosing()) {
+        closeWhenDrained(loop, *connection, fd, generation, !result.has_more_data);
         return;
     }
+    
+    if (!result.has_more_data && connection->isWriteArmed()) {
+        connection->setWriteArmed(false);
+        loop.getPoller().modifyFd(fd, client_events_, generation);
+    }
+}
 
-    if (result.bytes_read == 0) return;
-    auto messages = connection->extractMessages();
-    for (const auto& msg : messages) {
-        thread_pool_->addTask([this, fd, msg]() {
-            handleRequest(fd, msg);
+void ChatRoomServer::handleFlush(EventLoop& loop, int fd, uint32_t generation) {
+    auto connection = loopConnection(loop, fd, generation);
+    if (!connection) return;
+
+    // 先清标记再写 写的过程中新入队的帧会再次排队 不会丢失
+    connection->clearFlushQueued();
+    // 已经在等EPOLLOUT 说明socket写满了 交给handleWriteEvent
+    if (connection->isWriteArmed()) return;
+
+    auto result = connection->sendFromWriteBuffer(fd);
+    if (result.error) {
+        handleConnectionError(fd, generation);
+        return;
+    }
+    if (connection->isClosing()) {
+        closeWhenDrained(loop, *connection, fd, generation, !result.has_more_data);
+        return;
+    }
+
+    if (result.has_more_data) {
+        connection->setWriteArmed(true);
+        loop.getPoller().modifyFd(fd, client_events_ | EPOLLOUT, generation);
+    }
+}
+
+void ChatRoomServer::closeWhenDrained(EventLoop& loop, Connection& connection, int fd, uint32_t generation, bool drained) {
+    if (drained) {
+        cleanupConnection(fd, generation);
+        return;
+    }
+    if (!connection.isDrainTimerArmed()) {
+        connection.setDrainTimerArmed(true);
+        // 只等可写 不再读 水平触发下不读的数据也不会反复报告EPOLLIN
+        connection.setWriteArmed(true);
+        loop.getPoller().modifyFd(fd, (client_events_ & ~static_cast<uint32_t>(EPOLLIN)) | EPOLLOUT, generation);
+        // 对端不读时不能一直挂着 generation不符时cleanupConnection什么都不做
+        loop.runAfter(close_drain_timeout_ms_, [this, fd, generation]() {
+            cleanupConnection(fd, generation);
         });
     }
 }
 
-void ChatRoomServer::handleWriteEvent(int fd) {
-    Connection* connection = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = connections_.find(fd);
-        if (it == connections_.end()) {
-            thread_pool_->addTask([this, fd]() {
-                cleanupConnection(fd);
-            });
-            return;
-        }
-        connection = it->second.get();
+void ChatRoomServer::scheduleHeartbeat(EventLoop& loop, std::weak_ptr<Connection> weak, uint64_t delayMs) {
+    // 连接关闭后不取消定时器 到期时weak_ptr失效直接返回即可
+    loop.runAfter(delayMs, [this, &loop, weak = std::move(weak)]() {
+        checkHeartbeat(loop, weak);
+    });
+}
+
+void ChatRoomServer::checkHeartbeat(EventLoop& loop, const std::weak_ptr<Connection>& weak) {
+    auto connection = weak.lock();
+    if (!connection) return;
+
+    int fd = connection->getFd();
+    // fd可能已被新连接复用
+    if (!connections_.get(fd, connection->getGeneration())) return;
+
+    uint64_t now = TimerWheel::nowMs();
+    uint64_t idle = now - std::min(now, connection->getLastActiveMs());
+    if (idle < heartbeat_interval_ms_) {
+        // 期间有数据到达 按最后活跃时间顺延 不必每次收包都重设定时器
+        connection->setPingSentMs(0);
+        scheduleHeartbeat(loop, weak, heartbeat_interval_ms_ - idle);
+        return;
     }
 
-    auto result = connection->sendFromWriteBuffer(fd, 4096);
-    
-    if (result.error) {
-        handleConnectionError(fd);
+    uint64_t pingSent = connection->getPingSentMs();
+    if (pingSent == 0) {
+        connection->sendMessage(MSG_PING, "{}");
+        connection->setPingSentMs(now);
+        scheduleHeartbeat(loop, weak, heartbeat_timeout_ms_);
         return;
     }
-    
-    if (!result.has_more_data) poller_.modifyFd(fd, EPOLLIN);
+    if (now - pingSent < heartbeat_timeout_ms_) {
+        scheduleHeartbeat(loop, weak, heartbeat_timeout_ms_ - (now - pingSent));
+        return;
+    }
+
+    std::cerr << "Heartbeat timeout on fd " << fd << ", closing connection" << std::endl;
+    connection->sendMessage(MSG_HEARTBEAT_TIMEOUT, "{}");
+    cleanupConnection(fd, connection->getGeneration());
 }
 
-void ChatRoomServer::handleConnectionError(int fd) {
-    thread_pool_->addTask([this, fd]() {
-        cleanupConnection(fd);
+void ChatRoomServer::handleConnectionError(int fd, uint32_t generation) {
+    control_lane_->executor().addTask([this, fd, generation]() {
+        cleanupConnection(fd, generation);
     });
 }
 
-void ChatRoomServer::cleanupConnection(int fd) {
+void ChatRoomServer::cleanupConnection(int fd, uint32_t generation) {
+    // 只有从表中移除了这一代连接的调用方才能继续 其余的(重复清理或fd已被新连接复用)直接返回
+    // fd在本函数末尾才关闭 在此之前不会被复用 下面按fd清理映射表是安全的
+    auto connection = connections_.remove(fd, generation);
+    if (!connection) return;
+
+    detachSession(fd, *connection);
+
+    // 先在连接的锁内置关闭标记 工作线程的直接发送不会再写这个fd
+    connection->markClosed();
+    loops_[connection->getLoopIndex()]->getPoller().removeFd(fd);
+    ::close(fd);
+}
+
+void ChatRoomServer::detachSession(int fd, Connection& connection) {
     int userId = -1;
     int roomId = -1;
-    
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = connections_.find(fd);
-        if (it != connections_.end()) {
-            connections_.erase(it);
-        }
-    }
+    // 注销或被踢下线 这个连接上的令牌不能再被使用
+    revokeToken(connection.clearSession());
 
     {
         std::lock_guard<std::mutex> lock(fd_to_userId_mutex_);
@@ -335,10 +748,6 @@ void ChatRoomServer::cleanupConnection(int fd) {
     }
 
 
-    poller_.removeFd(fd);
-    ::close(fd);
-
-
     if (roomId != -1) {
         Json::Value notification;
         notification["user_id"] = userId;
@@ -347,68 +756,76 @@ void ChatRoomServer::cleanupConnection(int fd) {
     }    
 }
 
-void ChatRoomServer::handleRequest(int fd, const NetworkMessage& message) {
+CoTask<void> ChatRoomServer::handleRequest(int fd, uint32_t generation, NetworkMessage message) {
+    // 排队期间连接已关闭 fd甚至可能被新连接复用 这条请求不再处理
+    // 被踢下线等待发完通知的连接也不再处理
+    auto connection = connections_.get(fd, generation);
+    if (!connection || connection->isClosing()) co_return;
+
     switch (message.type) {
         case MSG_REGISTER: 
-            handleRegister(fd, message.data);
+            handleRegister(fd, message.data.view());
             break;
         case MSG_CHANGE_PASSWORD:
-            handleChangePassword(fd, message.data);
+            handleChangePassword(fd, message.data.view());
             break;
         case MSG_CHANGE_DISPLAY_NAME:
-            handleChangeDisplayName(fd, message.data);
+            handleChangeDisplayName(fd, message.data.view());
             break;
         case MSG_LOGIN:
-            handleLogin(fd, message.data);
+            co_await handleLogin(fd, generation, message.data.view());
             break;
         case MSG_LOGOUT:
-            handleLogout(fd, message.data);
+            handleLogout(fd, generation, message.data.view());
             break;
         case MSG_FETCH_ACTIVE_ROOMS:
-            handleFetchActiveRooms(fd, message.data);
+            handleFetchActiveRooms(fd, message.data.view());
             break;
         case MSG_FETCH_INACTIVE_ROOMS:
-            handleFetchInactiveRooms(fd, message.data);
+            handleFetchInactiveRooms(fd, message.data.view());
             break;
         case MSG_CREATE_ROOM:
-            handleCreateRoom(fd, message.data);
+            handleCreateRoom(fd, message.data.view());
             break;
         case MSG_DELETE_ROOM:
-            handleDeleteRoom(fd, message.data);
+            handleDeleteRoom(fd, message.data.view());
             break;
         case MSG_SET_ROOM_NAME:
-            handleSetRoomName(fd, message.data);
+            handleSetRoomName(fd, message.data.view());
             break;
         case MSG_SET_ROOM_DESCRIPTION:
-            handleSetRoomDescription(fd, message.data);
+            handleSetRoomDescription(fd, message.data.view());
             break;
         case MSG_SET_ROOM_MAX_USERS:
-            handleSetRoomMaxUsers(fd, message.data);
+            handleSetRoomMaxUsers(fd, message.data.view());
             break;
         case MSG_SET_ROOM_STATUS:
-            handleSetRoomStatus(fd, message.data);
+            handleSetRoomStatus(fd, message.data.view());
             break;
         case MSG_SEND_MESSAGE:
-            handleSendMessage(fd, message.data);
+            co_await handleSendMessage(fd, message.data.view());
             break;
         case MSG_GET_MESSAGE_HISTORY:
-            handleGetMessageHistory(fd, message.data);
+            co_await handleGetMessageHistory(fd, message.data.view());
             break;
         case MSG_JOIN_ROOM:
-            handleJoinRoom(fd, message.data);
+            handleJoinRoom(fd, message.data.view());
             break;
         case MSG_LEAVE_ROOM:
-            handleLeaveRoom(fd, message.data);
+            handleLeaveRoom(fd, message.data.view());
             break;
         case MSG_GET_USER_INFO:
-            handleGetUserInfo(fd, message.data);
+            handleGetUserInfo(fd, message.data.view());
+            break;
+        case MSG_FETCH_SERVER_STATS:
+            handleFetchServerStats(fd, message.data.view());
             break;
         default:
             break;
     }
 }
 
-void ChatRoomServer::handleGetUserInfo(int fd, const std::string& data) {
+void ChatRoomServer::handleGetUserInfo(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_GET_USER_INFO_RESPONSE, "JSON格式错误");
@@ -446,7 +863,115 @@ void ChatRoomServer::handleGetUserInfo(int fd, const std::string& data) {
     sendResponse(fd, MSG_GET_USER_INFO_RESPONSE, response);
 }
 
-void ChatRoomServer::handleRegister(int fd, const std::string& data) {
+void ChatRoomServer::handleFetchServerStats(int fd, std::string_view data) {
+    Json::Value root;
+    if (!parseJson(data, root)) {
+        sendErrorResponse(fd, MSG_FETCH_SERVER_STATS_RESPONSE, "JSON格式错误");
+        return;
+    }
+
+    if (!validateRequiredFields(root, {"token"})) {
+        sendErrorResponse(fd, MSG_FETCH_SERVER_STATS_RESPONSE, "缺少必需参数");
+        return;
+    }
+
+    std::string token = root["token"].asString();
+    int result = validateToken(fd, token);
+    if (result == 2) {
+        sendErrorResponse(fd, MSG_FETCH_SERVER_STATS_RESPONSE, "Token无效或已过期, 请重新登录");
+        return;
+    } else if (result == 0) {
+        sendErrorResponse(fd, MSG_FETCH_SERVER_STATS_RESPONSE, "需要管理员权限");
+        return;
+    }
+
+    Json::Value response;
+    response["success"] = true;
+    response["stats"] = collectStats();
+
+    sendResponse(fd, MSG_FETCH_SERVER_STATS_RESPONSE, response);
+}
+
+Json::Value ChatRoomServer::collectStats() const {
+    Json::Value stats;
+
+    stats["loops"] = Json::Value(Json::arrayValue);
+    for (const auto& loop : loops_) {
+        LoopStats loopStats = loop->getStats();
+        Json::Value l;
+        l["iterations"] = Json::UInt64(loopStats.iterations);
+        l["events"] = Json::UInt64(loopStats.events);
+        l["blocked_us"] = Json::UInt64(loopStats.blocked_us);
+        l["processing_us"] = Json::UInt64(loopStats.processing_us);
+        l["last_events"] = Json::UInt64(loopStats.last_events);
+        l["last_blocked_us"] = Json::UInt64(loopStats.last_blocked_us);
+        l["last_processing_us"] = Json::UInt64(loopStats.last_processing_us);
+        stats["loops"].append(l);
+    }
+
+    stats["lanes"] = Json::Value(Json::arrayValue);
+    for (const auto* lane : {control_lane_.get(), db_lane_.get(), cpu_lane_.get()}) {
+        stats["lanes"].append(laneToJson(lane->getStats()));
+    }
+
+    AsyncDbStats dbStats = async_db_->getStats();
+    stats["db_io"]["in_flight"] = Json::UInt64(dbStats.in_flight);
+    stats["db_io"]["peak_in_flight"] = Json::UInt64(dbStats.peak_in_flight);
+    stats["db_io"]["completed"] = Json::UInt64(dbStats.completed);
+    stats["db_io"]["pool"] = executorToJson(dbStats.pool);
+
+    BackpressureStats bp = backpressure_->getStats();
+    stats["backpressure"]["queued_bytes"] = Json::UInt64(bp.queued_bytes);
+    stats["backpressure"]["congestion_events"] = Json::UInt64(bp.congestion_events);
+    stats["backpressure"]["dropped_frames"] = Json::UInt64(bp.dropped_frames);
+    stats["backpressure"]["dropped_bytes"] = Json::UInt64(bp.dropped_bytes);
+    stats["backpressure"]["coalesced_frames"] = Json::UInt64(bp.coalesced_frames);
+    stats["backpressure"]["budget_rejections"] = Json::UInt64(bp.budget_rejections);
+    stats["backpressure"]["disconnects"] = Json::UInt64(bp.disconnects);
+
+    RevocationStats revocation = revoked_tokens_.getStats();
+    stats["revoked_tokens"]["size"] = Json::UInt64(revocation.size);
+    stats["revoked_tokens"]["revoked"] = Json::UInt64(revocation.revoked);
+    stats["revoked_tokens"]["expired"] = Json::UInt64(revocation.expired);
+    stats["revoked_tokens"]["expire_lock_hold_us"] = histogramToJson(revocation.expire_lock_hold_us);
+
+    stats["profile_cache"]["hits"] = Json::UInt64(profile_cache_hits_.load(std::memory_order_relaxed));
+    stats["profile_cache"]["misses"] = Json::UInt64(profile_cache_misses_.load(std::memory_order_relaxed));
+
+    RoomHistoryStats history = room_history_->getStats();
+    stats["history_cache"]["hits"] = Json::UInt64(history_cache_hits_.load(std::memory_order_relaxed));
+    stats["history_cache"]["misses"] = Json::UInt64(history_cache_misses_.load(std::memory_order_relaxed));
+    stats["history_cache"]["rooms"] = Json::UInt64(history.rooms);
+    stats["history_cache"]["messages"] = Json::UInt64(history.messages);
+    stats["history_cache"]["unpersisted"] = Json::UInt64(history.unpersisted);
+    stats["history_cache"]["warmups"] = Json::UInt64(history.warmups);
+    stats["history_cache"]["warmup_waits"] = Json::UInt64(history.warmup_waits);
+
+    MessageBatcherStats batcher = message_batcher_->getStats();
+    stats["message_persistence"]["pending"] = Json::UInt64(batcher.pending);
+    stats["message_persistence"]["persisted"] = Json::UInt64(batcher.persisted);
+    stats["message_persistence"]["batches"] = Json::UInt64(batcher.batches);
+    stats["message_persistence"]["retries"] = Json::UInt64(batcher.retries);
+    stats["message_persistence"]["failed"] = Json::UInt64(batcher.failed);
+    stats["message_persistence"]["rejected"] = Json::UInt64(batcher.rejected);
+    stats["message_persistence"]["batch_size"] = histogramToJson(batcher.batch_size);
+    stats["message_persistence"]["flush_us"] = histogramToJson(batcher.flush_us);
+
+    // 以消息类型为键 只列出处理过的类型
+    stats["requests"] = Json::Value(Json::objectValue);
+    for (const auto& [type, metrics] : request_metrics_) {
+        HistogramSnapshot wait = metrics->wait_us.snapshot();
+        if (wait.count == 0) continue;
+        Json::Value r;
+        r["wait_us"] = histogramToJson(wait);
+        r["run_us"] = histogramToJson(metrics->run_us.snapshot());
+        stats["requests"][std::to_string(type)] = r;
+    }
+
+    return stats;
+}
+
+void ChatRoomServer::handleRegister(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_REGISTER_RESPONSE, "JSON格式错误");
@@ -472,7 +997,7 @@ void ChatRoomServer::handleRegister(int fd, const std::string& data) {
     sendResponse(fd, MSG_REGISTER_RESPONSE, response);
 }
 
-void ChatRoomServer::handleChangePassword(int fd, const std::string& data) {
+void ChatRoomServer::handleChangePassword(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_CHANGE_PASSWORD_RESPONSE, "JSON格式错误");
@@ -498,7 +1023,7 @@ void ChatRoomServer::handleChangePassword(int fd, const std::string& data) {
     sendResponse(fd, MSG_CHANGE_PASSWORD_RESPONSE, response);
 }
 
-void ChatRoomServer::handleChangeDisplayName(int fd, const std::string& data) {
+void ChatRoomServer::handleChangeDisplayName(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_CHANGE_DISPLAY_NAME_RESPONSE, "JSON格式错误");
@@ -527,6 +1052,17 @@ void ChatRoomServer::handleChangeDisplayName(int fd, const std::string& data) {
     }
     
     auto serviceResult = service_manager_->changeDisplayName(userId, root["display_name"].asString());
+    if (serviceResult.ok) {
+        // 改名会重新分配discriminator 读回新的显示名刷新会话缓存 读取失败就清空 下次发消息时再查
+        std::shared_ptr<const std::string> displayName;
+        auto userResult = service_manager_->getUserInfo(userId);
+        if (userResult.ok) {
+            displayName = std::make_shared<const std::string>(userResult.data.name + "#" + userResult.data.discriminator);
+        }
+        if (auto connection = connections_.get(fd)) {
+            connection->setDisplayName(std::move(displayName));
+        }
+    }
     
     Json::Value response;
     response["success"] = serviceResult.ok;
@@ -536,22 +1072,32 @@ void ChatRoomServer::handleChangeDisplayName(int fd, const std::string& data) {
     sendResponse(fd, MSG_CHANGE_DISPLAY_NAME_RESPONSE, response);
 }
 
-void ChatRoomServer::handleLogin(int fd, const std::string& data) {
+CoTask<void> ChatRoomServer::handleLogin(int fd, uint32_t generation, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_LOGIN_RESPONSE, "JSON格式错误");
-        return;
+        co_return;
     }
 
     if (!validateRequiredFields(root, {"email", "password"})) {
         sendErrorResponse(fd, MSG_LOGIN_RESPONSE, "缺少必需参数");
-        return;
+        co_return;
     }
     
-    auto result = service_manager_->login(
-        root["email"].asString(),
-        root["password"].asString()
-    );
+    std::string email = root["email"].asString();
+    std::string password = root["password"].asString();
+    // 只有查询在数据库I/O线程上进行 期间本线程去处理其他请求
+    auto fetched = co_await async_db_->run([&]() {
+        return service_manager_->fetchLoginCredentials(email);
+    });
+    // 密码哈希一定在cpu通道上算 不占用数据库I/O线程 也不占用处理普通请求的通道
+    auto result = ServiceResult<User>::Fail(fetched.code, fetched.message);
+    if (fetched.ok) {
+        co_await Executor::switchTo(cpu_lane_->executor());
+        result = service_manager_->verifyLogin(fetched.data, password);
+    }
+    // 挂起期间连接可能已关闭 fd甚至已被复用 不能再登记会话
+    if (!connections_.get(fd, generation)) co_return;
     
     Json::Value response;
     response["success"] = result.ok;
@@ -560,6 +1106,13 @@ void ChatRoomServer::handleLogin(int fd, const std::string& data) {
     
     if (result.ok) {
         int userId = result.data.id;
+        bool isAdmin = result.data.is_admin;
+        // 先签发令牌 失败时不踢旧连接也不登记新会话
+        std::string token = generateToken(fd, userId, isAdmin);
+        if (token.empty()) {
+            sendErrorResponse(fd, MSG_LOGIN_RESPONSE, "登录失败, 请稍后再试", ErrorCode::INTERNAL_ERROR);
+            co_return;
+        }
         
         int oldFd = -1;
         {
@@ -573,26 +1126,15 @@ void ChatRoomServer::handleLogin(int fd, const std::string& data) {
             }
         }
         
-        if (oldFd != -1) {
+        // 映射表只记fd 旧fd上现在的连接必须仍是这个用户的会话 否则已被清理或复用 不能误踢
+        auto oldConnection = oldFd != -1 ? connections_.get(oldFd) : nullptr;
+        if (oldConnection && oldConnection->getUserId() == userId) {
+            // 会话立即解除 连接留给所属事件循环发完通知后关闭(超时则强制关闭)
+            // 旧连接晚些关闭时已查不到这个用户 不会影响新会话的映射和房间
             uint16_t kickMsg = htons(MSG_ACCOUNT_KICKED);
-            constexpr int maxRetries = 10;
-            constexpr int retryDelayMs = 10;
-            
-            for (int i = 0; i < maxRetries; ++i) {
-                ssize_t sent = ::send(oldFd, &kickMsg, sizeof(kickMsg), 0);
-                
-                if (sent == sizeof(kickMsg)) {
-                    break;
-                }
-                
-                if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(retryDelayMs));
-                } else {
-                    break;
-                }
-            }
-            
-            cleanupConnection(oldFd);
+            detachSession(oldFd, *oldConnection);
+            oldConnection->closeAfterFlush(std::make_shared<const std::string>(
+                reinterpret_cast<const char*>(&kickMsg), sizeof(kickMsg)));
         }
         
         {
@@ -605,8 +1147,10 @@ void ChatRoomServer::handleLogin(int fd, const std::string& data) {
             userId_to_fd_[userId] = fd;
         }
         
-        bool isAdmin = result.data.is_admin;
-        std::string token = generateToken(userId, isAdmin ? "a" : "u");
+        // 登录结果里已有用户资料 缓存到会话 发消息时不必再查数据库
+        if (auto connection = connections_.get(fd)) {
+            connection->setDisplayName(std::make_shared<const std::string>(result.data.name + "#" + result.data.discriminator));
+        }
         response["token"] = token;
         
         response["user"] = Json::Value();
@@ -656,7 +1200,7 @@ void ChatRoomServer::handleLogin(int fd, const std::string& data) {
     sendResponse(fd, MSG_LOGIN_RESPONSE, response);
 }
 
-void ChatRoomServer::handleLogout(int fd, const std::string& data) {
+void ChatRoomServer::handleLogout(int fd, uint32_t generation, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_LOGOUT_RESPONSE, "JSON格式错误");
@@ -675,10 +1219,10 @@ void ChatRoomServer::handleLogout(int fd, const std::string& data) {
         return;
     }
     
-    cleanupConnection(fd);
+    cleanupConnection(fd, generation);
 }
 
-void ChatRoomServer::handleFetchActiveRooms(int fd, const std::string& data) {
+void ChatRoomServer::handleFetchActiveRooms(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_FETCH_ACTIVE_ROOMS_RESPONSE, "JSON格式错误");
@@ -720,7 +1264,7 @@ void ChatRoomServer::handleFetchActiveRooms(int fd, const std::string& data) {
     sendResponse(fd, MSG_FETCH_ACTIVE_ROOMS_RESPONSE, response);
 }
 
-void ChatRoomServer::handleFetchInactiveRooms(int fd, const std::string& data) {
+void ChatRoomServer::handleFetchInactiveRooms(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_FETCH_INACTIVE_ROOMS_RESPONSE, "JSON格式错误");
@@ -765,7 +1309,7 @@ void ChatRoomServer::handleFetchInactiveRooms(int fd, const std::string& data) {
     sendResponse(fd, MSG_FETCH_INACTIVE_ROOMS_RESPONSE, response);
 }
 
-void ChatRoomServer::handleCreateRoom(int fd, const std::string& data) {
+void ChatRoomServer::handleCreateRoom(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_CREATE_ROOM_RESPONSE, "JSON格式错误");
@@ -826,7 +1370,7 @@ void ChatRoomServer::handleCreateRoom(int fd, const std::string& data) {
     sendResponse(fd, MSG_CREATE_ROOM_RESPONSE, response);
 }
 
-void ChatRoomServer::handleDeleteRoom(int fd, const std::string& data) {
+void ChatRoomServer::handleDeleteRoom(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_DELETE_ROOM_RESPONSE, "JSON格式错误");
@@ -855,6 +1399,8 @@ void ChatRoomServer::handleDeleteRoom(int fd, const std::string& data) {
     response["type"] = MSG_DELETE_ROOM_RESPONSE;
     response["success"] = serviceResult.ok;
     if (serviceResult.ok) {
+        room_history_->dropRoom(roomId);
+        room_sequences_.dropRoom(roomId);
         {
             std::lock_guard<std::mutex> lock(active_rooms_mutex_);
             active_rooms_.erase(roomId);
@@ -870,7 +1416,7 @@ void ChatRoomServer::handleDeleteRoom(int fd, const std::string& data) {
     sendResponse(fd, MSG_DELETE_ROOM_RESPONSE, response);
 }
 
-void ChatRoomServer::handleSetRoomName(int fd, const std::string& data) {
+void ChatRoomServer::handleSetRoomName(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_SET_ROOM_NAME_RESPONSE, "JSON格式错误");
@@ -930,7 +1476,7 @@ void ChatRoomServer::handleSetRoomName(int fd, const std::string& data) {
     sendResponse(fd, MSG_SET_ROOM_NAME_RESPONSE, response);
 }
 
-void ChatRoomServer::handleSetRoomDescription(int fd, const std::string& data) {
+void ChatRoomServer::handleSetRoomDescription(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_SET_ROOM_DESCRIPTION_RESPONSE, "JSON格式错误");
@@ -990,7 +1536,7 @@ void ChatRoomServer::handleSetRoomDescription(int fd, const std::string& data) {
     sendResponse(fd, MSG_SET_ROOM_DESCRIPTION_RESPONSE, response);
 }
 
-void ChatRoomServer::handleSetRoomMaxUsers(int fd, const std::string& data) {
+void ChatRoomServer::handleSetRoomMaxUsers(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_SET_ROOM_MAX_USERS_RESPONSE, "JSON格式错误");
@@ -1050,7 +1596,7 @@ void ChatRoomServer::handleSetRoomMaxUsers(int fd, const std::string& data) {
     sendResponse(fd, MSG_SET_ROOM_MAX_USERS_RESPONSE, response);
 }
 
-void ChatRoomServer::handleSetRoomStatus(int fd, const std::string& data) {
+void ChatRoomServer::handleSetRoomStatus(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_SET_ROOM_STATUS_RESPONSE, "JSON格式错误");
@@ -1119,29 +1665,29 @@ void ChatRoomServer::handleSetRoomStatus(int fd, const std::string& data) {
     sendResponse(fd, MSG_SET_ROOM_STATUS_RESPONSE, response);
 }
 
-void ChatRoomServer::handleSendMessage(int fd, const std::string& data) {
+CoTask<void> ChatRoomServer::handleSendMessage(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "JSON格式错误");
-        return;
+        co_return;
     }
     
     if (!validateRequiredFields(root, {"message", "token"})) {
         sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "缺少必需参数");
-        return;
+        co_return;
     }
     
     std::string token = root["token"].asString();
     int result = validateToken(fd, token);
     if (result == 2) {
         sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "Token无效或已过期");
-        return;
+        co_return;
     }
 
     std::string message = root["message"].asString();
     if (message.empty()) {
         sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "消息不能为空");
-        return;
+        co_return;
     }
 
     int userId = -1;
@@ -1150,7 +1696,7 @@ void ChatRoomServer::handleSendMessage(int fd, const std::string& data) {
         auto it = fd_to_userId_.find(fd);
         if (it == fd_to_userId_.end()) {
             sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "用户未登录");
-            return;
+            co_return;
         }
         userId = it->second;
     }
@@ -1161,55 +1707,111 @@ void ChatRoomServer::handleSendMessage(int fd, const std::string& data) {
         auto it = userId_to_roomId_.find(userId);
         if (it == userId_to_roomId_.end()) {
             sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "您当前不在任何房间中");
-            return;
+            co_return;
         }
         roomId = it->second;
     }
     
-    auto userResult = service_manager_->getUserInfo(userId);
-    if (!userResult.ok) {
-        sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "获取用户信息失败");
-        return;
+    // 显示名取自会话缓存 只有缓存被清空(如改名后刷新失败)时才查数据库
+    std::string display_name;
+    auto connection = connections_.get(fd);
+    auto cachedName = connection ? connection->getDisplayName() : nullptr;
+    if (cachedName) {
+        profile_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        display_name = *cachedName;
+    } else {
+        profile_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+        auto userResult = co_await async_db_->run([&]() {
+            return service_manager_->getUserInfo(userId);
+        });
+        if (!userResult.ok) {
+            sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "获取用户信息失败");
+            co_return;
+        }
+        display_name = userResult.data.name + "#" + userResult.data.discriminator;
+        if (connection) connection->setDisplayName(std::make_shared<const std::string>(display_name));
+    }
+
+    // 不等数据库 交给批量写入线程后立即推送 客户端要求durable时等落库结果再回复
+    // id和序号在房间锁内分配并推送 同一房间的推送按序号顺序发出
+    bool durable = root.get("durable", false).asBool();
+    AsyncResult<bool> persisted;
+    int64_t messageId = 0;
+    // 接收者在锁外查好 锁内只分配序号并把同一帧放进各连接的发送队列 发送留到释放锁之后
+    auto recipients = roomConnections(roomId);
+    std::vector<std::shared_ptr<Connection>> toFlush;
+    toFlush.reserve(recipients.size());
+    int64_t roomSeq = room_sequences_.next(roomId, [&](int64_t seq) {
+        Message record(message_ids_->next(), userId, roomId, seq, message, display_name,
+                       TimeUtils::getCurrentTimeString());
+        // 先进内存副本再提交 落库回调在写入线程执行时这条一定已经在副本里
+        // 落库前副本不能丢掉这条 回调里解除 写入失败则从副本移除
+        RoomHistoryCache* history = room_history_.get();
+        bool tracked = history->append(record);
+        auto onPersisted = [history, roomId, messageId = record.message_id, tracked, durable, persisted](bool ok) {
+            if (tracked) history->markPersisted(roomId, messageId, ok);
+            if (durable) persisted.set(ok);
+        };
+        if (!message_batcher_->submit(record, std::move(onPersisted))) {
+            if (tracked) history->markPersisted(roomId, record.message_id, false);
+            return false;
+        }
+
+        messageId = record.message_id;
+
+        Json::Value notification;
+        notification["message_id"] = Json::Int64(record.message_id);
+        notification["room_id"] = roomId;
+        notification["room_seq"] = Json::Int64(seq);
+        notification["display_name"] = display_name;
+        notification["message"] = message;
+        notification["timestamp"] = TimeUtils::getCurrentTimestamp();
+        SharedFrame frame = Connection::encodeFrame(MSG_CHAT_MESSAGE_PUSH, notification.toStyledString());
+        for (const auto& recipient : recipients) {
+            if (recipient->queueFrame(frame)) toFlush.push_back(recipient);
+        }
+        return true;
+    });
+    for (const auto& recipient : toFlush) {
+        recipient->flushQueued();
     }
-    
-    std::string display_name = userResult.data.name + "#" + userResult.data.discriminator;
-    auto serviceResult = service_manager_->sendMessage(userId, roomId, message, display_name, TimeUtils::getCurrentTimeString());
-    if (!serviceResult.ok) {
-        sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "消息发送失败");
-        return;
+    if (roomSeq == 0) {
+        sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "服务器繁忙, 请稍后再试", ErrorCode::SERVICE_UNAVAILABLE);
+        co_return;
     }
 
-    Json::Value notification;
-    notification["display_name"] = display_name;
-    notification["message"] = message;
-    notification["timestamp"] = TimeUtils::getCurrentTimestamp();
-    notifyRoomUsers(roomId, MSG_CHAT_MESSAGE_PUSH, notification);
+    if (durable && !co_await persisted) {
+        sendErrorResponse(fd, MSG_SEND_MESSAGE_RESPONSE, "消息保存失败", ErrorCode::INTERNAL_ERROR);
+        co_return;
+    }
 
     Json::Value response;
     response["type"] = MSG_SEND_MESSAGE_RESPONSE;
-    response["success"] = serviceResult.ok;
+    response["success"] = true;
+    response["message_id"] = Json::Int64(messageId);
+    response["room_seq"] = Json::Int64(roomSeq);
 
     sendResponse(fd, MSG_SEND_MESSAGE_RESPONSE, response);
 }
 
-// 函数有待优化 按理来说是像qq那样子无限网上拉取消息 那就还需要一个参数来表示位置
-void ChatRoomServer::handleGetMessageHistory(int fd, const std::string& data) {
+// 游标分页: before_message_id为上一页最旧一条的id 不传表示从最新开始 每页最多limit条
+CoTask<void> ChatRoomServer::handleGetMessageHistory(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_GET_MESSAGE_HISTORY_RESPONSE, "JSON格式错误");
-        return;
+        co_return;
     }
 
     if (!validateRequiredFields(root, {"token"})) {
         sendErrorResponse(fd, MSG_GET_MESSAGE_HISTORY_RESPONSE, "缺少必需参数");
-        return;
+        co_return;
     }
 
     std::string token = root["token"].asString();
     int result = validateToken(fd, token);
     if (result == 2) {
         sendErrorResponse(fd, MSG_GET_MESSAGE_HISTORY_RESPONSE, "Token无效或已过期, 请重新登录");
-        return;
+        co_return;
     }
 
     int userId = -1;
@@ -1218,7 +1820,7 @@ void ChatRoomServer::handleGetMessageHistory(int fd, const std::string& data) {
         auto it = fd_to_userId_.find(fd);
         if (it == fd_to_userId_.end()) {
             sendErrorResponse(fd, MSG_GET_MESSAGE_HISTORY_RESPONSE, "用户未登录");
-            return;
+            co_return;
         }
         userId = it->second;
     }
@@ -1229,28 +1831,82 @@ void ChatRoomServer::handleGetMessageHistory(int fd, const std::string& data) {
         auto it = userId_to_roomId_.find(userId);
         if (it == userId_to_roomId_.end()) {
             sendErrorResponse(fd, MSG_GET_MESSAGE_HISTORY_RESPONSE, "您当前不在任何房间中");
-            return;
+            co_return;
         }
         roomId = it->second;
     }
 
-    auto serviceResult = service_manager_->getMessageHistory(roomId, 50);
+    int64_t beforeMessageId = std::numeric_limits<int64_t>::max();
+    if (root.isMember("before_message_id")) {
+        beforeMessageId = root["before_message_id"].asInt64();
+    }
+    int limit = std::clamp(root.get("limit", MESSAGE_HISTORY_DEFAULT_LIMIT).asInt(), 1, MESSAGE_HISTORY_MAX_LIMIT);
+    // 多取一条用来判断是否还有更早的消息
+    size_t fetchCount = static_cast<size_t>(limit) + 1;
+
+    // 先查内存副本 房间还没加载时由一个请求去数据库加载 同时到达的其他请求等它的结果
+    auto cached = room_history_->recent(roomId, beforeMessageId, fetchCount);
+    if (!cached && !room_history_->isWarm(roomId)) {
+        auto ticket = room_history_->acquireWarm(roomId);
+        if (ticket.load) {
+            size_t capacity = room_history_->capacity();
+            auto warmResult = co_await async_db_->run([&]() {
+                return service_manager_->getMessageHistory(roomId, static_cast<int>(capacity));
+            });
+            room_history_->completeWarm(roomId, warmResult.ok ? &warmResult.data : nullptr, capacity);
+        } else {
+            co_await ticket.ready;
+        }
+        cached = room_history_->recent(roomId, beforeMessageId, fetchCount);
+    }
+
+    auto toJson = [](const Message& msg) {
+        Json::Value messageObj;
+        messageObj["message_id"] = Json::Int64(msg.message_id);
+        messageObj["user_id"] = msg.user_id;
+        messageObj["room_id"] = msg.room_id;
+        messageObj["room_seq"] = Json::Int64(msg.room_seq);
+        messageObj["content"] = msg.content;
+        messageObj["display_name"] = msg.display_name;
+        messageObj["send_time"] = msg.send_time;
+        return messageObj;
+    };
+
+    Json::Value history(Json::arrayValue);
+    ServiceResult<void> serviceResult = ServiceResult<void>::Ok("消息获取成功");
+    if (cached) {
+        history_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        for (const auto& msg : *cached) history.append(toJson(msg));
+    } else {
+        // 还在写入队列里的消息数据库查不到 它们比已落库的都新 先放在前面 数据库从它们之前接着取
+        // 超出内存副本的部分逐行取出直接转成JSON 不再拷贝一份消息列表
+        history_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+        auto pending = room_history_->unpersisted(roomId, beforeMessageId, fetchCount);
+        for (const auto& msg : pending) history.append(toJson(msg));
+        int64_t dbBefore = pending.empty() ? beforeMessageId : pending.back().message_id;
+        size_t remaining = fetchCount - pending.size();
+        if (remaining > 0) {
+            serviceResult = co_await async_db_->run([&]() {
+                return service_manager_->streamMessageHistory(roomId, dbBefore, static_cast<int>(remaining),
+                    [&](const Message& msg) {
+                        history.append(toJson(msg));
+                        return true;
+                    });
+            });
+        }
+    }
 
     Json::Value response;
     response["type"] = MSG_GET_MESSAGE_HISTORY_RESPONSE;
     response["success"] = serviceResult.ok;
     if (serviceResult.ok) {
-        response["message_history"] = Json::Value(Json::arrayValue);
-        for (const auto& msg : serviceResult.data) {
-            Json::Value messageObj;
-            messageObj["message_id"] = msg.message_id;
-            messageObj["user_id"] = msg.user_id;
-            messageObj["room_id"] = msg.room_id;
-            messageObj["content"] = msg.content;
-            messageObj["display_name"] = msg.display_name;
-            messageObj["send_time"] = msg.send_time;
-            response["message_history"].append(messageObj);
+        bool hasMore = history.size() > static_cast<Json::ArrayIndex>(limit);
+        if (hasMore) history.resize(static_cast<Json::ArrayIndex>(limit));
+        response["has_more"] = hasMore;
+        if (!history.empty()) {
+            response["next_before_message_id"] = history[history.size() - 1]["message_id"];
         }
+        response["message_history"] = std::move(history);
     } else {
         response["message"] = serviceResult.message;
     }
@@ -1258,7 +1914,7 @@ void ChatRoomServer::handleGetMessageHistory(int fd, const std::string& data) {
     sendResponse(fd, MSG_GET_MESSAGE_HISTORY_RESPONSE, response);
 }
 
-void ChatRoomServer::handleJoinRoom(int fd, const std::string& data) {
+void ChatRoomServer::handleJoinRoom(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_JOIN_ROOM_RESPONSE, "JSON格式错误");
@@ -1324,7 +1980,7 @@ void ChatRoomServer::handleJoinRoom(int fd, const std::string& data) {
     sendResponse(fd, MSG_JOIN_ROOM_RESPONSE, response);
 }
 
-void ChatRoomServer::handleLeaveRoom(int fd, const std::string& data) {
+void ChatRoomServer::handleLeaveRoom(int fd, std::string_view data) {
     Json::Value root;
     if (!parseJson(data, root)) {
         sendErrorResponse(fd, MSG_LEAVE_ROOM_RESPONSE, "JSON格式错误");
@@ -1389,6 +2045,17 @@ void ChatRoomServer::handleLeaveRoom(int fd, const std::string& data) {
 }
 
 void ChatRoomServer::notifyRoomUsers(int roomId, uint16_t messageType, const Json::Value& notification) {
+    auto recipients = roomConnections(roomId);
+    if (recipients.empty()) return;
+
+    // 只序列化一次 所有接收者共享同一帧
+    SharedFrame frame = Connection::encodeFrame(messageType, notification.toStyledString());
+    for (const auto& connection : recipients) {
+        connection->sendFrame(frame);
+    }
+}
+
+std::vector<std::shared_ptr<Connection>> ChatRoomServer::roomConnections(int roomId) {
     std::vector<int> userIdsToNotify;
     
     {
@@ -1414,14 +2081,17 @@ void ChatRoomServer::notifyRoomUsers(int roomId, uint16_t messageType, const Jso
         }
     }
     
+    std::vector<std::shared_ptr<Connection>> connections;
+    connections.reserve(fdsToNotify.size());
     for (int fd : fdsToNotify) {
-        sendResponse(fd, messageType, notification);
+        if (auto connection = connections_.get(fd)) connections.push_back(std::move(connection));
     }
+    return connections;
 }
 
-bool ChatRoomServer::parseJson(const std::string& data, Json::Value& root) {
+bool ChatRoomServer::parseJson(std::string_view data, Json::Value& root) {
     Json::Reader reader;
-    return reader.parse(data, root);
+    return reader.parse(data.data(), data.data() + data.size(), root);
 }
 
 bool ChatRoomServer::validateRequiredFields(const Json::Value& root, const std::vector<std::string>& requiredFields) {
@@ -1434,92 +2104,67 @@ bool ChatRoomServer::validateRequiredFields(const Json::Value& root, const std::
 }
 
 void ChatRoomServer::sendResponse(int fd, uint16_t responseType, const Json::Value& response) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    auto it = connections_.find(fd);
-    if (it != connections_.end()) {
-        it->second->sendMessage(responseType, response.toStyledString());
+    sendFrame(fd, Connection::encodeFrame(responseType, response.toStyledString()));
+}
+
+void ChatRoomServer::sendFrame(int fd, const SharedFrame& frame) {
+    if (!frame) return;
+    if (auto connection = connections_.get(fd)) {
+        connection->sendFrame(frame);
     }
 }
 
-void ChatRoomServer::sendErrorResponse(int fd, uint16_t responseType, const std::string& message) {
+void ChatRoomServer::sendErrorResponse(int fd, uint16_t responseType, const std::string& message, ErrorCode code) {
     Json::Value response;
     response["success"] = false;
     response["message"] = message;
-    response["code"] = 400;
+    response["code"] = static_cast<int>(code);
     sendResponse(fd, responseType, response);
 }
 
-std::string ChatRoomServer::generateToken(int userId, const std::string& role) {
-    auto timestamp = TimeUtils::getCurrentTimestamp();
-    
-    std::string roleChar = (role == "admin") ? "a" : "n";
-    int counter = token_counter_.fetch_add(1) % 10000;
-    std::string token = roleChar + "_" + 
-                       std::to_string(timestamp) + "_" +
-                       std::to_string(counter);
-    
-    int64_t expireTime = timestamp + (token_expire_minutes_ * 60 * 1000);
-    
-    {
-        std::lock_guard<std::mutex> lock(userId_to_token_mutex_);
-        userId_to_token_[userId] = std::make_pair(token, expireTime);
+std::string ChatRoomServer::generateToken(int fd, int userId, bool isAdmin) {
+    int64_t expireTime = TimeUtils::getCurrentTimestamp() + token_expire_minutes_ * 60 * 1000;
+    TokenClaims claims;
+    std::string token = token_signer_->issue(userId, isAdmin, expireTime, &claims);
+    if (token.empty()) return token;
+
+    // 同一连接重复登录时 之前签发的令牌作废
+    if (auto connection = connections_.get(fd)) {
+        revokeToken(connection->setSession(userId, claims.token_id));
     }
-    
     return token;
 }
 
 int ChatRoomServer::validateToken(int fd, std::string& token) {
-    int userId = -1;
-    {
-        std::lock_guard<std::mutex> lock(fd_to_userId_mutex_);
-        auto it = fd_to_userId_.find(fd);
-        if (it != fd_to_userId_.end()) {
-            userId = it->second;
-        }
+    auto claims = token_signer_->verify(token, TimeUtils::getCurrentTimestamp());
+    if (!claims) {
+        return 2;
     }
 
-    if (userId == -1) {
+    // 令牌只能在登录为同一用户的连接上使用
+    auto connection = connections_.get(fd);
+    if (!connection || connection->getUserId() != claims->user_id) {
         return 2;
     }
 
-    auto currentTime = TimeUtils::getCurrentTimestamp();
-
-    {
-        std::lock_guard<std::mutex> lock(userId_to_token_mutex_);
-        auto it = userId_to_token_.find(userId);
-        if (it == userId_to_token_.end()) {
-            return 2;
-        }
-        
-        if (currentTime > it->second.second) {
-            return 2;
-        }
-        
-        if (it->second.first != token) {
-            return 2;
-        }
-        
-        if (token[0] == 'a') {
-            return 1;
-        } else if (token[0] == 'n') {
-            return 0;
-        }
+    if (revoked_tokens_.contains(claims->token_id)) {
+        return 2;
     }
 
-    return 2;
+    return claims->is_admin ? 1 : 0;
 }
 
-// 本质上清理线程也应该分区域 但考虑到量级不大 就先这样了
-void ChatRoomServer::cleanupExpiredTokens() {
-    auto currentTime = TimeUtils::getCurrentTimestamp();
-    
-    std::lock_guard<std::mutex> lock(userId_to_token_mutex_);
-    
-    for (auto it = userId_to_token_.begin(); it != userId_to_token_.end();) {
-        if (currentTime > it->second.second) {
-            it = userId_to_token_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
\ No newline at end of file
+void ChatRoomServer::revokeToken(uint64_t tokenId) {
+    if (tokenId == 0) return;
+    // 吊销条目保留到令牌最晚的过期时间
+    revoked_tokens_.revoke(tokenId, TimeUtils::getCurrentTimestamp() + token_expire_minutes_ * 60 * 1000);
+}
+
+// 令牌本身不需要清理 只清除吊销集合里已经过期的条目
+// 分摊到每个tick 单次持锁时间有上限 不会长时间阻塞令牌校验 也不需要专门的清理线程
+void ChatRoomServer::scheduleTokenExpiry(EventLoop& loop) {
+    loop.runAfter(token_expiry_tick_ms_, [this, &loop]() {
+        revoked_tokens_.expire(TimeUtils::getCurrentTimestamp(), token_expiry_batch_);
+        scheduleTokenExpiry(loop);
+    });
+}
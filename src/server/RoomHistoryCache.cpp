@@ -0,0 +1,166 @@
+#include "server/RoomHistoryCache.h"
+#include <algorithm>
+#include <iterator>
+
+RoomHistoryCache::RoomHistoryCache(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::shared_ptr<RoomHistoryCache::Ring> RoomHistoryCache::ring(int roomId, bool create) {
+    std::lock_guard<std::mutex> lock(rooms_mutex_);
+    auto it = rooms_.find(roomId);
+    if (it != rooms_.end()) return it->second;
+    if (!create) return nullptr;
+    return rooms_.emplace(roomId, std::make_shared<Ring>()).first->second;
+}
+
+bool RoomHistoryCache::insertLocked(Ring& ring, const Message& message) {
+    auto& messages = ring.messages;
+    auto pos = messages.end();
+    while (pos != messages.begin() && std::prev(pos)->message_id > message.message_id) --pos;
+    if (pos != messages.begin() && std::prev(pos)->message_id == message.message_id) return false;
+    messages.insert(pos, message);
+    return true;
+}
+
+void RoomHistoryCache::trimLocked(Ring& ring) {
+    size_t keep = std::max<size_t>(capacity_, static_cast<size_t>(ring.unpersisted));
+    while (ring.messages.size() > keep) {
+        ring.messages.pop_front();
+        ring.evicted = true;
+        ring.complete = false;
+    }
+}
+
+bool RoomHistoryCache::append(const Message& message) {
+    auto r = ring(message.room_id, true);
+    std::lock_guard<std::mutex> lock(r->mutex);
+    bool inserted = insertLocked(*r, message);
+    if (inserted) ++r->unpersisted;
+    trimLocked(*r);
+    return inserted;
+}
+
+void RoomHistoryCache::markPersisted(int roomId, int64_t messageId, bool ok) {
+    // 房间已删除时副本跟着没了 不用处理
+    auto r = ring(roomId, false);
+    if (!r) return;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    // 只在末尾未落库的部分里找 不在其中说明是删除前旧副本的消息 计数与它无关
+    auto& messages = r->messages;
+    auto tail = messages.end() - std::min(static_cast<size_t>(r->unpersisted), messages.size());
+    auto it = std::find_if(tail, messages.end(),
+        [messageId](const Message& message) { return message.message_id == messageId; });
+    if (it == messages.end()) return;
+    if (!ok) messages.erase(it);
+    --r->unpersisted;
+    trimLocked(*r);
+}
+
+std::vector<Message> RoomHistoryCache::unpersisted(int roomId, int64_t beforeMessageId, size_t limit) {
+    std::vector<Message> result;
+    auto r = ring(roomId, false);
+    if (!r) return result;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    size_t count = std::min(static_cast<size_t>(r->unpersisted), r->messages.size());
+    for (auto it = r->messages.rbegin(); it != r->messages.rbegin() + count && result.size() < limit; ++it) {
+        if (it->message_id < beforeMessageId) result.push_back(*it);
+    }
+    return result;
+}
+
+std::optional<std::vector<Message>> RoomHistoryCache::recent(int roomId, int64_t beforeMessageId, size_t limit) {
+    auto r = ring(roomId, false);
+    if (!r) return std::nullopt;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (!r->warm) return std::nullopt;
+
+    auto end = std::lower_bound(r->messages.begin(), r->messages.end(), beforeMessageId,
+        [](const Message& message, int64_t id) { return message.message_id < id; });
+    size_t available = static_cast<size_t>(end - r->messages.begin());
+    // 副本之前可能还有更早的消息 除非副本就是房间的全部消息
+    if (available < limit && !r->complete) return std::nullopt;
+
+    size_t count = std::min(limit, available);
+    std::vector<Message> result(std::make_reverse_iterator(end), std::make_reverse_iterator(end) + count);
+    return result;
+}
+
+bool RoomHistoryCache::isWarm(int roomId) {
+    auto r = ring(roomId, false);
+    if (!r) return false;
+    std::lock_guard<std::mutex> lock(r->mutex);
+    return r->warm;
+}
+
+RoomHistoryCache::WarmTicket RoomHistoryCache::acquireWarm(int roomId) {
+    auto r = ring(roomId, true);
+    WarmTicket ticket{false, AsyncResult<bool>()};
+    std::lock_guard<std::mutex> lock(r->mutex);
+    if (r->warm) {
+        ticket.ready.set(true);
+    } else if (r->loading) {
+        warmup_waits_.fetch_add(1, std::memory_order_relaxed);
+        r->waiters.push_back(ticket.ready);
+    } else {
+        warmups_.fetch_add(1, std::memory_order_relaxed);
+        r->loading = true;
+        ticket.load = true;
+    }
+    return ticket;
+}
+
+void RoomHistoryCache::completeWarm(int roomId, const std::vector<Message>* rows, size_t requested) {
+    auto r = ring(roomId, false);
+    if (!r) return;
+    std::vector<AsyncResult<bool>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        // 加载期间房间被删除后又重建 新的副本不是这次加载的对象
+        if (!r->loading) return;
+        r->loading = false;
+        waiters.swap(r->waiters);
+        if (rows) {
+            // 数据库里的都比内存中已有的旧或相同 逐条按id合并即可
+            for (const auto& message : *rows) insertLocked(*r, message);
+            trimLocked(*r);
+            r->warm = true;
+            r->complete = rows->size() < requested && !r->evicted;
+        }
+    }
+    // 等待方的恢复不在持锁时进行
+    for (auto& waiter : waiters) waiter.set(rows != nullptr);
+}
+
+void RoomHistoryCache::dropRoom(int roomId) {
+    std::shared_ptr<Ring> r;
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        auto it = rooms_.find(roomId);
+        if (it == rooms_.end()) return;
+        r = std::move(it->second);
+        rooms_.erase(it);
+    }
+    // 正在加载的结果不会再写回 直接让等待方回退到数据库
+    std::vector<AsyncResult<bool>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        waiters.swap(r->waiters);
+    }
+    for (auto& waiter : waiters) waiter.set(false);
+}
+
+RoomHistoryStats RoomHistoryCache::getStats() const {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        rings.reserve(rooms_.size());
+        for (const auto& [roomId, r] : rooms_) rings.push_back(r);
+    }
+    RoomHistoryStats stats{rings.size(), 0, 0, warmups_.load(std::memory_order_relaxed),
+                           warmup_waits_.load(std::memory_order_relaxed)};
+    for (const auto& r : rings) {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        stats.messages += r->messages.size();
+        stats.unpersisted += static_cast<uint64_t>(r->unpersisted);
+    }
+    return stats;
+}
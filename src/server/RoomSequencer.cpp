@@ -0,0 +1,20 @@
+#include "server/RoomSequencer.h"
+#include <algorithm>
+
+void RoomSequencer::seed(int roomId, int64_t lastSeq) {
+    auto r = room(roomId);
+    std::lock_guard<std::mutex> lock(r->mutex);
+    r->last = std::max(r->last, lastSeq);
+}
+
+void RoomSequencer::dropRoom(int roomId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rooms_.erase(roomId);
+}
+
+std::shared_ptr<RoomSequencer::Room> RoomSequencer::room(int roomId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& r = rooms_[roomId];
+    if (!r) r = std::make_shared<Room>();
+    return r;
+}
@@ -1,4 +1,5 @@
 #include "service/BaseService.h"
+#include "utils/PasswordHasher.h"
 #include <iostream>
 
 BaseService::BaseService() {
@@ -32,6 +33,26 @@ ServiceResult<User> BaseService::login(const std::string& email, const std::stri
     return ServiceResult<User>::Ok(*userResult.data, "登录成功");
 }
 
+ServiceResult<UserCredentials> BaseService::fetchLoginCredentials(const std::string& email) {
+    auto userDao = getUserDao();
+    if (!userDao) return ServiceResult<UserCredentials>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
+
+    auto result = userDao->getUserCredentials(email);
+
+    if(result.isConnectionError()) return ServiceResult<UserCredentials>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
+    if(result.isInternalError()) return ServiceResult<UserCredentials>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
+    if(result.isNotFound()) return ServiceResult<UserCredentials>::Fail(ErrorCode::NOT_FOUND, "用户不存在");
+
+    return ServiceResult<UserCredentials>::Ok(*result.data);
+}
+
+ServiceResult<User> BaseService::verifyLogin(const UserCredentials& credentials, const std::string& password) {
+    if (!PasswordHasher::verifyPasswordWithFullHash(password, credentials.password_hash)) {
+        return ServiceResult<User>::Fail(ErrorCode::UNAUTHORIZED, "密码错误");
+    }
+    return ServiceResult<User>::Ok(credentials.user, "登录成功");
+}
+
 ServiceResult<std::vector<Room>> BaseService::getActiveRooms() {
     auto roomDao = getRoomDao();
     if (!roomDao) return ServiceResult<std::vector<Room>>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
@@ -0,0 +1,135 @@
+#include "service/MessageBatcher.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}
+
+MessageBatcher::MessageBatcher(FlushFunc flush, MessageBatcherConfig config)
+    : flush_(std::move(flush)), config_(config) {
+    config_.batch_size = std::max<size_t>(config_.batch_size, 1);
+    config_.flush_interval_ms = std::max(config_.flush_interval_ms, 0);
+    config_.max_retries = std::max(config_.max_retries, 0);
+    thread_ = std::thread(&MessageBatcher::run, this);
+}
+
+MessageBatcher::~MessageBatcher() {
+    stop();
+}
+
+bool MessageBatcher::submit(Message message, PersistedCallback onPersisted) {
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || queue_.size() >= config_.max_pending) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(Pending{std::move(message), std::move(onPersisted), std::chrono::steady_clock::now()});
+        size = queue_.size();
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    // 只在队列由空变非空或攒满一批时唤醒 其余情况后台线程在等超时
+    if (size == 1 || size == config_.batch_size) cv_.notify_one();
+    return true;
+}
+
+void MessageBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void MessageBatcher::run() {
+    const auto interval = std::chrono::milliseconds(config_.flush_interval_ms);
+    std::vector<Pending> batch;
+    batch.reserve(config_.batch_size);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) break;
+
+        // 不满一批时等到最早那条消息排队满flush_interval_ms 停止时不再等
+        if (!stopping_ && queue_.size() < config_.batch_size) {
+            cv_.wait_until(lock, queue_.front().enqueued + interval, [this] {
+                return stopping_ || queue_.size() >= config_.batch_size;
+            });
+        }
+
+        size_t count = std::min(queue_.size(), config_.batch_size);
+        std::move(queue_.begin(), queue_.begin() + count, std::back_inserter(batch));
+        queue_.erase(queue_.begin(), queue_.begin() + count);
+
+        lock.unlock();
+        flushBatch(batch);
+        batch.clear();
+        lock.lock();
+    }
+}
+
+void MessageBatcher::flushBatch(std::vector<Pending>& batch) {
+    std::vector<Message> messages;
+    messages.reserve(batch.size());
+    for (const auto& pending : batch) messages.push_back(pending.message);
+
+    bool ok = false;
+    auto backoff = std::chrono::milliseconds(config_.retry_backoff_ms);
+    for (int attempt = 0; ; ++attempt) {
+        uint64_t start = nowUs();
+        try {
+            ok = flush_(messages);
+        } catch (const std::exception& e) {
+            std::cerr << "Message flush threw: " << e.what() << std::endl;
+            ok = false;
+        }
+        flush_us_.record(nowUs() - start);
+        if (ok || attempt >= config_.max_retries) break;
+
+        retries_.fetch_add(1, std::memory_order_relaxed);
+        // 停止时不再退避等待 尽快把剩下的重试做完
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, backoff, [this] { return stopping_; });
+        backoff *= 2;
+    }
+
+    if (ok) {
+        persisted_.fetch_add(batch.size(), std::memory_order_relaxed);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        batch_size_.record(batch.size());
+    } else {
+        failed_.fetch_add(batch.size(), std::memory_order_relaxed);
+        std::cerr << "Dropped " << batch.size() << " messages after " << config_.max_retries
+                  << " retries (message_id " << batch.front().message.message_id
+                  << " .. " << batch.back().message.message_id << ")" << std::endl;
+    }
+    pending_.fetch_sub(batch.size(), std::memory_order_relaxed);
+
+    for (auto& pending : batch) {
+        if (pending.on_persisted) pending.on_persisted(ok);
+    }
+}
+
+MessageBatcherStats MessageBatcher::getStats() const {
+    MessageBatcherStats stats;
+    stats.pending = pending_.load(std::memory_order_relaxed);
+    stats.persisted = persisted_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.retries = retries_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.batch_size = batch_size_.snapshot();
+    stats.flush_us = flush_us_.snapshot();
+    return stats;
+}
@@ -26,18 +26,42 @@ ServiceResult<void> ServiceManager::changeDisplayName(int userId, const std::str
     return user_service_.changeDisplayName(userId, newName);
 }
 
-ServiceResult<void> ServiceManager::sendMessage(int userId, int roomId, const std::string& content, const std::string& displayName, const std::string& sendTime) {
-    return user_service_.sendMessage(userId, roomId, content, displayName, sendTime);
-}
-
 ServiceResult<std::vector<Message>> ServiceManager::getMessageHistory(int roomId, int limit) {
     return user_service_.getMessageHistory(roomId, limit);
 }
 
+ServiceResult<void> ServiceManager::streamMessageHistory(int roomId, int64_t beforeMessageId, int limit, const std::function<bool(const Message&)>& onMessage) {
+    return user_service_.streamMessageHistory(roomId, beforeMessageId, limit, onMessage);
+}
+
+ServiceResult<void> ServiceManager::saveMessages(const std::vector<Message>& messages) {
+    return user_service_.saveMessages(messages);
+}
+
+ServiceResult<int64_t> ServiceManager::getMaxMessageId() {
+    return user_service_.getMaxMessageId();
+}
+
+ServiceResult<std::vector<std::pair<int, int64_t>>> ServiceManager::getRoomSequences() {
+    return user_service_.getRoomSequences();
+}
+
+ServiceResult<bool> ServiceManager::acquireMessageWriterLock() {
+    return user_service_.acquireMessageWriterLock();
+}
+
 ServiceResult<User> ServiceManager::login(const std::string& email, const std::string& password) {
     return user_service_.BaseService::login(email, password);
 }
 
+ServiceResult<UserCredentials> ServiceManager::fetchLoginCredentials(const std::string& email) {
+    return user_service_.BaseService::fetchLoginCredentials(email);
+}
+
+ServiceResult<User> ServiceManager::verifyLogin(const UserCredentials& credentials, const std::string& password) {
+    return BaseService::verifyLogin(credentials, password);
+}
+
 ServiceResult<std::vector<Room>> ServiceManager::getActiveRooms() {
     return user_service_.BaseService::getActiveRooms();
 }
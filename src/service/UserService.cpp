@@ -53,24 +53,70 @@ ServiceResult<void> UserService::changeDisplayName(int userId, const std::string
     return ServiceResult<void>::Ok("用户名修改成功");
 }
 
-ServiceResult<void> UserService::sendMessage(int userId, int roomId, const std::string& content, const std::string& displayName, const std::string& sendTime) {
+ServiceResult<std::vector<Message>> UserService::getMessageHistory(int roomId, int limit) {
+    auto messageDao = getMessageDao();
+    if (!messageDao) return ServiceResult<std::vector<Message>>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
+
+    auto result = messageDao->getRecentMessages(roomId, limit);
+
+    if(result.isConnectionError()) return ServiceResult<std::vector<Message>>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
+    if(result.isInternalError()) return ServiceResult<std::vector<Message>>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
+    // 房间还没有消息时查询结果为NOT_FOUND 按空列表返回
+    if(result.isNotFound()) return ServiceResult<std::vector<Message>>::Ok({}, "消息获取成功");
+    return ServiceResult<std::vector<Message>>::Ok(*result.data, "消息获取成功");
+}
+
+ServiceResult<void> UserService::streamMessageHistory(int roomId, int64_t beforeMessageId, int limit, const std::function<bool(const Message&)>& onMessage) {
     auto messageDao = getMessageDao();
     if (!messageDao) return ServiceResult<void>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
 
-    auto result = messageDao->sendMessageToRoom(userId, roomId, content, displayName, sendTime);
+    auto result = messageDao->streamMessagesBefore(roomId, beforeMessageId, limit, onMessage);
 
     if(result.isConnectionError()) return ServiceResult<void>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
     if(result.isInternalError()) return ServiceResult<void>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
-    return ServiceResult<void>::Ok("消息发送成功");
+    return ServiceResult<void>::Ok("消息获取成功");
 }
 
-ServiceResult<std::vector<Message>> UserService::getMessageHistory(int roomId, int limit) {
+ServiceResult<void> UserService::saveMessages(const std::vector<Message>& messages) {
     auto messageDao = getMessageDao();
-    if (!messageDao) return ServiceResult<std::vector<Message>>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
+    if (!messageDao) return ServiceResult<void>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
 
-    auto result = messageDao->getRecentMessages(roomId, limit);
+    auto result = messageDao->insertMessages(messages);
 
-    if(result.isConnectionError()) return ServiceResult<std::vector<Message>>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
-    if(result.isInternalError()) return ServiceResult<std::vector<Message>>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
-    return ServiceResult<std::vector<Message>>::Ok(*result.data, "消息获取成功");
+    if(result.isConnectionError()) return ServiceResult<void>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
+    if(result.isInternalError()) return ServiceResult<void>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
+    return ServiceResult<void>::Ok("消息保存成功");
+}
+
+ServiceResult<int64_t> UserService::getMaxMessageId() {
+    auto messageDao = getMessageDao();
+    if (!messageDao) return ServiceResult<int64_t>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
+
+    auto result = messageDao->getMaxMessageId();
+
+    if(result.isConnectionError()) return ServiceResult<int64_t>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
+    if(result.isInternalError() || !result.data) return ServiceResult<int64_t>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
+    return ServiceResult<int64_t>::Ok(*result.data, "获取成功");
+}
+
+ServiceResult<std::vector<std::pair<int, int64_t>>> UserService::getRoomSequences() {
+    auto messageDao = getMessageDao();
+    if (!messageDao) return ServiceResult<std::vector<std::pair<int, int64_t>>>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
+
+    auto result = messageDao->getRoomSequences();
+
+    if(result.isConnectionError()) return ServiceResult<std::vector<std::pair<int, int64_t>>>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
+    if(result.isInternalError() || !result.data) return ServiceResult<std::vector<std::pair<int, int64_t>>>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
+    return ServiceResult<std::vector<std::pair<int, int64_t>>>::Ok(*result.data, "获取成功");
+}
+
+ServiceResult<bool> UserService::acquireMessageWriterLock() {
+    auto messageDao = getMessageDao();
+    if (!messageDao) return ServiceResult<bool>::Fail(ErrorCode::INTERNAL_ERROR, "DAO层初始化失败");
+
+    auto result = messageDao->acquireWriterLock();
+
+    if(result.isConnectionError()) return ServiceResult<bool>::Fail(ErrorCode::INTERNAL_ERROR, "数据库连接失败");
+    if(result.isInternalError() || !result.data) return ServiceResult<bool>::Fail(ErrorCode::INTERNAL_ERROR, "数据库内部错误");
+    return ServiceResult<bool>::Ok(*result.data, "获取成功");
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "utils/CpuAffinity.h"
+#include <algorithm>
+#include <filesystem>
+#include <set>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+
+std::optional<std::vector<int>> CpuAffinity::parseCpuList(const std::string& spec) {
+    std::vector<int> cpus;
+    std::stringstream ss(spec);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        part.erase(std::remove_if(part.begin(), part.end(), ::isspace), part.end());
+        if (part.empty()) continue;
+        try {
+            size_t dash = part.find('-');
+            size_t used = 0;
+            if (dash == std::string::npos) {
+                int cpu = std::stoi(part, &used);
+                if (used != part.size() || cpu < 0) return std::nullopt;
+                cpus.push_back(cpu);
+            } else {
+                std::string lowStr = part.substr(0, dash);
+                std::string highStr = part.substr(dash + 1);
+                int low = std::stoi(lowStr, &used);
+                if (used != lowStr.size()) return std::nullopt;
+                int high = std::stoi(highStr, &used);
+                if (used != highStr.size() || low < 0 || high < low) return std::nullopt;
+                for (int cpu = low; cpu <= high; ++cpu) cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+    if (cpus.empty()) return std::nullopt;
+    for (int cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) return std::nullopt;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+bool CpuAffinity::pinCurrentThread(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int CpuAffinity::nodeOfCpu(int cpu) {
+    // /sys/devices/system/cpu/cpuN/ 下有一个nodeM目录(或链接)
+    std::error_code ec;
+    std::filesystem::path dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+            return std::stoi(name.substr(4));
+        }
+    }
+    return -1;
+}
+
+std::string CpuAffinity::describeCurrentThread() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<int> cpus;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+
+    std::set<int> nodes;
+    for (int cpu : cpus) nodes.insert(nodeOfCpu(cpu));
+
+    std::ostringstream oss;
+    oss << "cpus " << formatCpuList(cpus) << " (node";
+    for (int node : nodes) {
+        oss << ' ';
+        if (node < 0) oss << '?'; else oss << node;
+    }
+    oss << "), running on cpu " << sched_getcpu();
+    return oss.str();
+}
+
+std::string CpuAffinity::formatCpuList(const std::vector<int>& cpus) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (i > 0) oss << ',';
+        oss << cpus[i];
+        if (j > i) oss << '-' << cpus[j];
+        i = j + 1;
+    }
+    return oss.str();
+}
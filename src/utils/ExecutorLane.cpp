@@ -0,0 +1,45 @@
+#include "utils/ExecutorLane.h"
+
+ExecutorLane::ExecutorLane(std::string name, std::unique_ptr<Executor> executor, size_t queueLimit)
+    : name_(std::move(name)), executor_(std::move(executor)), queue_limit_(queueLimit) {}
+
+bool ExecutorLane::tryAcquire() {
+    uint64_t pending = pending_.fetch_add(1, std::memory_order_relaxed);
+    if (pending >= queue_limit_) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t peak = peak_pending_.load(std::memory_order_relaxed);
+    while (pending + 1 > peak &&
+           !peak_pending_.compare_exchange_weak(peak, pending + 1, std::memory_order_relaxed)) {}
+    return true;
+}
+
+void ExecutorLane::onStart(uint64_t waitUs) {
+    wait_us_.fetch_add(waitUs, std::memory_order_relaxed);
+}
+
+void ExecutorLane::onFinish(uint64_t runUs) {
+    run_us_.fetch_add(runUs, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+LaneStats ExecutorLane::getStats() const {
+    LaneStats stats;
+    stats.name = name_;
+    stats.threads = executor_->threadCount();
+    stats.queue_limit = queue_limit_;
+    stats.pending = pending_.load(std::memory_order_relaxed);
+    stats.peak_pending = peak_pending_.load(std::memory_order_relaxed);
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.pool = executor_->getStats();
+    stats.wait_us = wait_us_.load(std::memory_order_relaxed);
+    stats.run_us = run_us_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,65 @@
+#include "utils/Histogram.h"
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <utility>
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) return static_cast<size_t>(value);
+    // 最高位所在的幂区间 区间内取紧随最高位的SUB_BITS位作为子桶
+    int magnitude = 63 - std::countl_zero(value);
+    int shift = magnitude - SUB_BITS;
+    uint64_t sub = (value >> shift) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>(2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + sub);
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < 2 * SUB_BUCKETS) return index;
+    size_t rel = index - 2 * SUB_BUCKETS;
+    int shift = static_cast<int>(rel / SUB_BUCKETS) + 1;
+    uint64_t sub = rel % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snap;
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    snap.count = total;
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+    if (total == 0) return snap;
+
+    // 按名次找分位数所在的桶 报告值不超过记录到的最大值
+    const std::pair<double, uint64_t*> targets[] = {
+        {0.5, &snap.p50}, {0.9, &snap.p90}, {0.99, &snap.p99}, {0.999, &snap.p999}};
+    uint64_t seen = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && next < std::size(targets); ++i) {
+        seen += counts[i];
+        while (next < std::size(targets) &&
+               static_cast<double>(seen) >= targets[next].first * static_cast<double>(total)) {
+            *targets[next].second = std::min(bucketUpperBound(i), snap.max);
+            ++next;
+        }
+    }
+    return snap;
+}
+
+void Histogram::reset() {
+    for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,30 @@
+#include "utils/PoolMetrics.h"
+
+PoolMetrics::PoolMetrics(size_t workerCount)
+    : workers_(std::make_unique<WorkerCounters[]>(workerCount)), worker_count_(workerCount) {}
+
+void PoolMetrics::onTask(size_t worker, uint64_t idleUs, uint64_t runUs) {
+    // 单写者 用load+store代替fetch_add 避免总线锁
+    auto& counters = workers_[worker];
+    counters.tasks.store(counters.tasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    counters.busy_us.store(counters.busy_us.load(std::memory_order_relaxed) + runUs, std::memory_order_relaxed);
+    counters.idle_us.store(counters.idle_us.load(std::memory_order_relaxed) + idleUs, std::memory_order_relaxed);
+    run_.record(runUs);
+}
+
+ExecutorStats PoolMetrics::snapshot(const char* type) const {
+    ExecutorStats stats;
+    stats.type = type;
+    stats.threads = worker_count_;
+    stats.workers.reserve(worker_count_);
+    for (size_t i = 0; i < worker_count_; ++i) {
+        stats.workers.push_back(WorkerStats{
+            workers_[i].tasks.load(std::memory_order_relaxed),
+            workers_[i].busy_us.load(std::memory_order_relaxed),
+            workers_[i].idle_us.load(std::memory_order_relaxed)});
+    }
+    stats.queue_wait_us = queue_wait_.snapshot();
+    stats.run_us = run_.snapshot();
+    stats.queue_depth = queue_depth_.snapshot();
+    return stats;
+}
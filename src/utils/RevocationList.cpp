@@ -0,0 +1,79 @@
+#include "utils/RevocationList.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}
+
+void RevocationList::revoke(uint64_t tokenId, int64_t expiresMs) {
+    Shard& shard = shardFor(tokenId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.emplace(tokenId, expiresMs).second) {
+        // 向上取整到桶边界 保证桶到期时桶内条目都已过期
+        shard.buckets[(expiresMs + BUCKET_MS - 1) / BUCKET_MS].push_back(tokenId);
+        size_.fetch_add(1, std::memory_order_release);
+        revoked_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool RevocationList::contains(uint64_t tokenId) const {
+    // 绝大多数时间集合为空 不用加锁
+    if (size_.load(std::memory_order_acquire) == 0) return false;
+    const Shard& shard = shardFor(tokenId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.entries.count(tokenId) > 0;
+}
+
+size_t RevocationList::expireShard(Shard& shard, int64_t nowMs, size_t maxEntries) {
+    int64_t dueBucket = nowMs / BUCKET_MS;
+    size_t budget = std::min(maxEntries, EXPIRE_BATCH);
+    size_t removed = 0;
+
+    uint64_t lockStart = nowUs();
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (removed < budget && !shard.buckets.empty() && shard.buckets.begin()->first <= dueBucket) {
+            auto& ids = shard.buckets.begin()->second;
+            // 从桶尾部取 剩下的留在桶里下次继续
+            while (removed < budget && !ids.empty()) {
+                shard.entries.erase(ids.back());
+                ids.pop_back();
+                ++removed;
+            }
+            if (ids.empty()) shard.buckets.erase(shard.buckets.begin());
+        }
+    }
+    // 只统计真正做了清理的持锁 空转的检查不计入
+    if (removed > 0) expire_lock_hold_us_.record(nowUs() - lockStart);
+    return removed;
+}
+
+size_t RevocationList::expire(int64_t nowMs, size_t maxEntries) {
+    size_t removed = 0;
+    // 轮流处理各分片 一轮中每片最多持一次锁
+    for (size_t i = 0; i < SHARD_COUNT && removed < maxEntries; ++i) {
+        Shard& shard = shards_[next_shard_];
+        next_shard_ = (next_shard_ + 1) % SHARD_COUNT;
+        removed += expireShard(shard, nowMs, maxEntries - removed);
+    }
+    if (removed > 0) {
+        size_.fetch_sub(removed, std::memory_order_relaxed);
+        expired_.fetch_add(removed, std::memory_order_relaxed);
+    }
+    return removed;
+}
+
+RevocationStats RevocationList::getStats() const {
+    RevocationStats stats;
+    stats.size = size_.load(std::memory_order_relaxed);
+    stats.revoked = revoked_.load(std::memory_order_relaxed);
+    stats.expired = expired_.load(std::memory_order_relaxed);
+    stats.expire_lock_hold_us = expire_lock_hold_us_.snapshot();
+    return stats;
+}
@@ -0,0 +1,38 @@
+#include "utils/SnowflakeId.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+SnowflakeId::SnowflakeId(int64_t nodeId) : node_id_(nodeId) {
+    if (nodeId < 0 || nodeId > MAX_NODE_ID) {
+        throw std::invalid_argument("node id must be in [0, " + std::to_string(MAX_NODE_ID) + "], got " +
+                                    std::to_string(nodeId));
+    }
+}
+
+int64_t SnowflakeId::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t SnowflakeId::next() {
+    int64_t now = (nowMs() - EPOCH_MS) << SEQUENCE_BITS;
+    int64_t last = last_.load(std::memory_order_relaxed);
+    int64_t state;
+    do {
+        // 序号溢出时自然进位到时间戳 相当于借用下一毫秒
+        state = std::max(now, last + 1);
+    } while (!last_.compare_exchange_weak(last, state, std::memory_order_relaxed));
+
+    int64_t timestamp = state >> SEQUENCE_BITS;
+    return (timestamp << (NODE_BITS + SEQUENCE_BITS)) | (node_id_ << SEQUENCE_BITS) | (state & SEQUENCE_MASK);
+}
+
+void SnowflakeId::observe(int64_t id) {
+    // 跳到该id所在毫秒的最后一个序号 下一个id落在之后的毫秒 与节点号无关都比它大
+    int64_t state = ((id >> (NODE_BITS + SEQUENCE_BITS)) << SEQUENCE_BITS) | SEQUENCE_MASK;
+    int64_t last = last_.load(std::memory_order_relaxed);
+    while (last < state && !last_.compare_exchange_weak(last, state, std::memory_order_relaxed)) {
+    }
+}
@@ -0,0 +1,110 @@
+#include "utils/Strand.h"
+
+namespace {
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+}
+
+}
+
+Strand::Strand(Executor& executor) : executor_(executor) {}
+
+void Strand::post(Task task) {
+    enqueue(Entry{std::move(task), nullptr, Clock::now()});
+}
+
+void Strand::post(Task task, ExecutorLane& lane) {
+    enqueue(Entry{std::move(task), &lane, Clock::now()});
+}
+
+void Strand::postAsync(Task task, ExecutorLane& lane) {
+    enqueue(Entry{std::move(task), &lane, Clock::now(), true});
+}
+
+void Strand::enqueue(Entry entry) {
+    Executor* target;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(entry));
+        if (scheduled_) return;
+        scheduled_ = true;
+        target = &executorFor(tasks_.front());
+    }
+    schedule(*target);
+}
+
+void Strand::schedule(Executor& executor) {
+    // 持有shared_ptr 保证连接关闭后排队中的任务仍能安全执行完
+    auto self = shared_from_this();
+    Executor* current = &executor;
+    executor.addTask([self, current]() {
+        Executor::Scope scope(current);
+        self->run(current);
+    });
+}
+
+void Strand::run(Executor* current) {
+    for (size_t executed = 0; executed < MAX_BATCH; ++executed) {
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) {
+                scheduled_ = false;
+                return;
+            }
+            Executor& next = executorFor(tasks_.front());
+            if (&next != current) {
+                // 下一个任务属于另一条通道 交给那条通道继续执行 本线程释放
+                current = &next;
+                break;
+            }
+            entry = std::move(tasks_.front());
+            tasks_.pop_front();
+            if (entry.async) async_running_ = true;
+        }
+
+        auto start = Clock::now();
+        if (entry.lane) entry.lane->onStart(elapsedUs(entry.enqueued, start));
+        entry.task();
+
+        if (entry.async) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (async_running_) {
+                // 协程已挂起 由complete()负责记账和继续调度 本线程直接释放
+                suspended_ = true;
+                async_lane_ = entry.lane;
+                async_start_ = start;
+                return;
+            }
+        }
+        if (entry.lane) entry.lane->onFinish(elapsedUs(start, Clock::now()));
+    }
+
+    // 批次用完或需要换通道 重新排到对应执行器的队尾
+    schedule(*current);
+}
+
+void Strand::complete() {
+    Executor* target;
+    ExecutorLane* lane;
+    Clock::time_point start;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        async_running_ = false;
+        // 任务函数还没返回(同步完成) run()会接着执行下一个任务
+        if (!suspended_) return;
+        suspended_ = false;
+        lane = async_lane_;
+        start = async_start_;
+        async_lane_ = nullptr;
+        if (tasks_.empty()) {
+            scheduled_ = false;
+            target = nullptr;
+        } else {
+            target = &executorFor(tasks_.front());
+        }
+    }
+    if (lane) lane->onFinish(elapsedUs(start, Clock::now()));
+    if (target) schedule(*target);
+}
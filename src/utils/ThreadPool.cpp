@@ -1,8 +1,8 @@
 #include "utils/ThreadPool.h"
 
-ThreadPool::ThreadPool(size_t thread_count) {
+ThreadPool::ThreadPool(size_t thread_count, ThreadInit init) : metrics_(thread_count) {
     for (size_t i = 0; i < thread_count; ++i) {
-        threads_.emplace_back(&ThreadPool::worker, this);
+        threads_.emplace_back(&ThreadPool::worker, this, i, init);
     }
 }
 
@@ -10,12 +10,16 @@ ThreadPool::~ThreadPool() {
     stop();
 }
 
-void ThreadPool::addTask(const std::function<void()>& task) {
+void ThreadPool::addTask(Task task) {
+    uint64_t enqueued = PoolMetrics::nowUs();
+    size_t depth;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        tasks_.push(task);
+        tasks_.push(Item{std::move(task), enqueued});
+        depth = tasks_.size();
     }
     cond_.notify_one();
+    metrics_.onEnqueue(depth);
 }
 
 void ThreadPool::stop() {
@@ -26,16 +30,23 @@ void ThreadPool::stop() {
     }
 }
 
-void ThreadPool::worker() {
+void ThreadPool::worker(size_t index, const ThreadInit& init) {
+    if (init) init(index);
+    uint64_t idleSince = PoolMetrics::nowUs();
     while (running_) {
-        std::function<void()> task;
+        Item item;
         {
             std::unique_lock<std::mutex> lock(mutex_);
             cond_.wait(lock, [this] { return !tasks_.empty() || !running_; });
             if (!running_ && tasks_.empty()) return;
-            task = std::move(tasks_.front());
+            item = std::move(tasks_.front());
             tasks_.pop();
         }
-        task();
+        uint64_t start = PoolMetrics::nowUs();
+        metrics_.onDequeue(start > item.enqueued_us ? start - item.enqueued_us : 0);
+        item.task();
+        uint64_t end = PoolMetrics::nowUs();
+        metrics_.onTask(index, start - idleSince, end - start);
+        idleSince = end;
     }
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "utils/WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+
+// 当前线程所属的线程池及其工作线程下标 用于判断addTask是否来自本池的工作线程
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_worker_index = 0;
+
+size_t roundUpPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+}
+
+ChaseLevDeque::ChaseLevDeque(size_t capacity)
+    : capacity_(roundUpPowerOfTwo(std::max<size_t>(capacity, 2))), mask_(capacity_ - 1), slots_(new Slot[capacity_]) {}
+
+bool ChaseLevDeque::push(QueuedTask& task) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t >= static_cast<int64_t>(capacity_)) return false;
+    // 窃取者认领了这个槽上一轮的任务但还没移走 不能覆盖
+    Slot& slot = slots_[b & mask_];
+    if (slot.full.load(std::memory_order_acquire)) return false;
+
+    slot.task = std::move(task);
+    slot.full.store(true, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+QueuedTask ChaseLevDeque::take(int64_t i) {
+    Slot& slot = slots_[i & mask_];
+    QueuedTask task = std::move(slot.task);
+    slot.full.store(false, std::memory_order_release);
+    return task;
+}
+
+QueuedTask ChaseLevDeque::pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return QueuedTask();
+    }
+    if (t < b) return take(b);
+
+    // 只剩最后一个 与窃取者竞争 赢了才能读槽
+    bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won ? take(b) : QueuedTask();
+}
+
+QueuedTask ChaseLevDeque::steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return QueuedTask();
+
+    // 先认领再读槽 认领前读取可能与所属线程的写入交错
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return QueuedTask();
+    }
+    return take(t);
+}
+
+bool ChaseLevDeque::empty() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return t >= b;
+}
+
+MpmcQueue::MpmcQueue(size_t capacity)
+    : mask_(roundUpPowerOfTwo(std::max<size_t>(capacity, 2)) - 1), cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool MpmcQueue::push(QueuedTask& task) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[pos & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.task = std::move(task);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // 满
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+QueuedTask MpmcQueue::pop() {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[pos & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                QueuedTask task = std::move(cell.task);
+                cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                return task;
+            }
+        } else if (diff < 0) {
+            return QueuedTask();  // 空
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+WorkStealingPool::WorkStealingPool(size_t threadCount, ThreadInit init)
+    : metrics_(std::max<size_t>(threadCount, 1)), injection_(INJECTION_CAPACITY) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i, init);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    // 剩下的任务随队列一起析构 不再执行
+    stop();
+}
+
+void WorkStealingPool::addTask(Task task) {
+    QueuedTask item{std::move(task), PoolMetrics::nowUs()};
+    size_t depth = queued_.fetch_add(1, std::memory_order_relaxed) + 1;
+    bool queued = t_pool == this && workers_[t_worker_index]->deque.push(item);
+    if (!queued && !injection_.push(item)) {
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        overflow_.push_back(std::move(item));
+        overflow_size_.fetch_add(1, std::memory_order_release);
+    }
+    notify();
+    metrics_.onEnqueue(depth);
+}
+
+void WorkStealingPool::stop() {
+    if (!running_.exchange(false)) return;
+    wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+    wake_epoch_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void WorkStealingPool::notify() {
+    // 与workerLoop中先登记sleepers_再检查队列配对 保证不会漏唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        wake_epoch_.fetch_add(1, std::memory_order_release);
+        wake_epoch_.notify_one();
+    }
+}
+
+QueuedTask WorkStealingPool::popInjected() {
+    if (QueuedTask task = injection_.pop()) return task;
+    if (overflow_size_.load(std::memory_order_acquire) == 0) return QueuedTask();
+
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    if (overflow_.empty()) return QueuedTask();
+    QueuedTask task = std::move(overflow_.front());
+    overflow_.pop_front();
+    overflow_size_.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+QueuedTask WorkStealingPool::findTask(size_t index, uint64_t& rng) {
+    if (QueuedTask task = workers_[index]->deque.pop()) return task;
+    if (QueuedTask task = popInjected()) return task;
+
+    // 从随机位置开始依次尝试窃取
+    size_t n = workers_.size();
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    size_t start = static_cast<size_t>(rng % n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t victim = (start + i) % n;
+        if (victim == index) continue;
+        if (QueuedTask task = workers_[victim]->deque.steal()) return task;
+    }
+    return QueuedTask();
+}
+
+void WorkStealingPool::workerLoop(size_t index, const ThreadInit& init) {
+    if (init) init(index);
+    t_pool = this;
+    t_worker_index = index;
+    uint64_t rng = 0x9E3779B97F4A7C15ull * (index + 1);
+    uint64_t idleSince = PoolMetrics::nowUs();
+
+    while (true) {
+        QueuedTask task;
+        for (int spin = 0; spin < SPIN_ROUNDS && !task; ++spin) {
+            task = findTask(index, rng);
+            if (!task) {
+                if (!running_.load(std::memory_order_acquire)) return;
+                std::this_thread::yield();
+            }
+        }
+
+        if (!task) {
+            // 先登记为睡眠者再检查一次队列 之后投递的任务一定会看到sleepers_>0并唤醒
+            uint32_t epoch = wake_epoch_.load(std::memory_order_acquire);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            task = findTask(index, rng);
+            if (!task) {
+                if (!running_.load(std::memory_order_acquire)) {
+                    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+                wake_epoch_.wait(epoch, std::memory_order_acquire);
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                continue;
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        uint64_t start = PoolMetrics::nowUs();
+        metrics_.onDequeue(start > task.enqueued_us ? start - task.enqueued_us : 0);
+        task.task();
+        task.task.reset();
+        uint64_t end = PoolMetrics::nowUs();
+        metrics_.onTask(index, start - idleSince, end - start);
+        idleSince = end;
+    }
+}